@@ -396,6 +396,11 @@
 #define __NR_fanotify_init		(__NR_SYSCALL_BASE+367)
 #define __NR_fanotify_mark		(__NR_SYSCALL_BASE+368)
 #define __NR_prlimit64			(__NR_SYSCALL_BASE+369)
+					/* 370-373 reserved, see calls.S */
+#define __NR_sendmmsg			(__NR_SYSCALL_BASE+374)
+					/* 375-379 reserved, see calls.S */
+#define __NR_sched_setattr		(__NR_SYSCALL_BASE+380)
+#define __NR_sched_getattr		(__NR_SYSCALL_BASE+381)
 
 /*
  * The following SWIs are ARM private.
@@ -29,8 +29,16 @@
 #include <linux/uaccess.h>
 #include <linux/watchdog.h>
 #include <linux/jiffies.h>
+#include <linux/interrupt.h>
+#include <linux/kernel_stat.h>
+#include <linux/kmsg_dump.h>
+#include <linux/sched.h>
+#include <linux/clk.h>
+#include <linux/math64.h>
 
 #include <asm/io.h>
+#include <asm/irq.h>
+#include <asm/irq_regs.h>
 
 #include <mach/platform.h>
 #include <mach/map.h>
@@ -44,13 +52,21 @@
 #define WDT_DEFAULT_TIME	30	/* seconds */
 #define WDT_MAX_TIME		TICK_TO_SEC(0xfffffff)	/* seconds */
 
+/* number of recently scheduled tasks reported on pretimeout */
+#define WDT_HISTORY_LEN		8
+
 static int wdt_time = WDT_DEFAULT_TIME;
 static int nowayout = WATCHDOG_NOWAYOUT;
+static int pretimeout;
 
 module_param(wdt_time, int, 0);
 MODULE_PARM_DESC(wdt_time, "Watchdog time in seconds. (default="
 				__MODULE_STRING(WDT_DEFAULT_TIME) ")");
 
+module_param(pretimeout, int, 0);
+MODULE_PARM_DESC(pretimeout, "Seconds before reset at which a stall snapshot "
+				"is logged, 0 to disable. (default=0)");
+
 #ifdef CONFIG_WATCHDOG_NOWAYOUT
 module_param(nowayout, int, 0);
 MODULE_PARM_DESC(nowayout,
@@ -62,11 +78,44 @@ static int wdt_tick;
 static unsigned long p6_wdt_busy;
 static char expect_release;
 
+/* timer0 ticks per second, used for pretimeout */
+static unsigned long pretimeout_rate;
+/* interrupt counts at last keepalive, to spot interrupt storms */
+static unsigned int wdt_irq_count[NR_IRQS];
+
+/*
+ * The watchdog itself cannot raise an interrupt before reset: use spare
+ * timer0, rearmed on each keepalive, to expire 'pretimeout' seconds
+ * before the watchdog does.
+ */
+static void p6_wdt_pretimeout_arm(void)
+{
+	u64 ticks;
+	int irq;
+
+	__raw_writel(0, PARROT6_VA_SYS+_P6_SYS_TIM0CTL);
+	if (!pretimeout)
+		return;
+
+	for (irq = 0; irq < NR_IRQS; irq++)
+		wdt_irq_count[irq] = kstat_irqs(irq);
+
+	/* saturate: timer0 wraps after about 30 hours */
+	ticks = (u64)(wdt_time - pretimeout)*pretimeout_rate;
+	if (ticks > 0xffffffff)
+		ticks = 0xffffffff;
+
+	__raw_writel((u32)ticks, PARROT6_VA_SYS+_P6_SYS_TIM0LD);
+	__raw_writel(P6_SYS_TIMXCTL_PRESCALE4096|P6_SYS_TIMXCTL_ENABLE,
+		     PARROT6_VA_SYS+_P6_SYS_TIM0CTL);
+}
+
 static inline void p6_wdt_pet(void)
 {
 	/* we need to do this otherwise counter is not reloaded */
 	__raw_writel(0, PARROT6_VA_SYS + _P6_SYS_WDOGCTL);
 	__raw_writel(wdt_tick| P6_SYS_WDOGCTL_TICKEN|P6_SYS_WDOGCTL_WDOGEN, PARROT6_VA_SYS + _P6_SYS_WDOGCTL);
+	p6_wdt_pretimeout_arm();
 }
 
 static void p6_wdt_start(void)
@@ -75,7 +124,8 @@ static void p6_wdt_start(void)
 	u32 iten;
 	/* this is need even if we don't use IT */
 	local_irq_save(flags);
-	iten = __raw_readl(PARROT6_VA_SYS+_P6_SYS_ITEN)|P6_SYS_ITEN_TICK;
+	iten = __raw_readl(PARROT6_VA_SYS+_P6_SYS_ITEN)|P6_SYS_ITEN_TICK|
+		P6_SYS_ITEN_TIM0;
 	__raw_writel(iten, PARROT6_VA_SYS+_P6_SYS_ITEN);
 	local_irq_restore(flags);
 
@@ -88,16 +138,19 @@ static void p6_wdt_stop(void)
 	unsigned long flags;
 
 	local_irq_save(flags);
-	iten = __raw_readl(PARROT6_VA_SYS+_P6_SYS_ITEN) & (~P6_SYS_ITEN_TICK);
+	iten = __raw_readl(PARROT6_VA_SYS+_P6_SYS_ITEN) &
+		~(P6_SYS_ITEN_TICK|P6_SYS_ITEN_TIM0);
 	__raw_writel(iten, PARROT6_VA_SYS+_P6_SYS_ITEN);
 	local_irq_restore(flags);
 
+	__raw_writel(0, PARROT6_VA_SYS+_P6_SYS_TIM0CTL);
 	__raw_writel(0, PARROT6_VA_SYS + _P6_SYS_WDOGCTL);
 }
 
 static int p6_wdt_settimeout(int new_time)
 {
-	if ((new_time <= 0) || (new_time > WDT_MAX_TIME))
+	if ((new_time <= 0) || (new_time > WDT_MAX_TIME) ||
+	    (new_time <= pretimeout))
 		return -EINVAL;
 
 	wdt_time = new_time;
@@ -105,6 +158,85 @@ static int p6_wdt_settimeout(int new_time)
 	return 0;
 }
 
+static int p6_wdt_setpretimeout(int new_time)
+{
+	if ((new_time < 0) || (new_time >= wdt_time))
+		return -EINVAL;
+
+	pretimeout = new_time;
+	return 0;
+}
+
+#ifdef CONFIG_SCHEDSTATS
+/* log the tasks which were scheduled most recently, latest first */
+static void p6_wdt_show_history(void)
+{
+	struct task_struct *g, *p, *hist[WDT_HISTORY_LEN];
+	unsigned long long now = sched_clock();
+	unsigned int i, n = 0;
+
+	read_lock(&tasklist_lock);
+	do_each_thread(g, p) {
+		for (i = n; i > 0; i--) {
+			if (hist[i-1]->sched_info.last_arrival >=
+			    p->sched_info.last_arrival)
+				break;
+			if (i < WDT_HISTORY_LEN)
+				hist[i] = hist[i-1];
+		}
+		if (i < WDT_HISTORY_LEN) {
+			hist[i] = p;
+			if (n < WDT_HISTORY_LEN)
+				n++;
+		}
+	} while_each_thread(g, p);
+
+	printk(KERN_EMERG DRV_NAME ": recently scheduled tasks:\n");
+	for (i = 0; i < n; i++)
+		printk(KERN_EMERG "  %-16s pid %5d state %ld prio %d "
+		       "ran %llu us ago, %lu times\n",
+		       hist[i]->comm, task_pid_nr(hist[i]), hist[i]->state,
+		       hist[i]->prio,
+		       div_u64(now - hist[i]->sched_info.last_arrival, 1000),
+		       hist[i]->sched_info.pcount);
+	read_unlock(&tasklist_lock);
+}
+#else
+static inline void p6_wdt_show_history(void)
+{
+}
+#endif
+
+static irqreturn_t p6_wdt_pretimeout_interrupt(int irq, void *dev_id)
+{
+	struct pt_regs *regs = get_irq_regs();
+	unsigned int count;
+
+	__raw_writel(0, PARROT6_VA_SYS+_P6_SYS_TIM0CTL);
+	__raw_writel(P6_SYS_ITACK_TIM0, PARROT6_VA_SYS+_P6_SYS_ITACK);
+
+	printk(KERN_EMERG DRV_NAME ": pretimeout, reset in %d seconds\n",
+	       pretimeout);
+	printk(KERN_EMERG DRV_NAME ": interrupted task %s (pid %d)\n",
+	       current->comm, task_pid_nr(current));
+	if (regs)
+		show_regs(regs);
+
+	p6_wdt_show_history();
+
+	printk(KERN_EMERG DRV_NAME ": interrupts since last keepalive:\n");
+	for (irq = 0; irq < NR_IRQS; irq++) {
+		count = kstat_irqs(irq) - wdt_irq_count[irq];
+		if (count)
+			printk(KERN_EMERG "  irq %2d: %u\n", irq, count);
+	}
+
+	/* save the log to persistent storage (ramoops) before reset */
+	kmsg_dump(KMSG_DUMP_OOPS);
+
+	return IRQ_HANDLED;
+}
+
 static int p6_wdt_open(struct inode *inode, struct file *file)
 {
 	if (test_and_set_bit(0, &p6_wdt_busy))
@@ -154,6 +286,7 @@ static ssize_t p6_wdt_write(struct file *file, const char __user *data,
 static const struct watchdog_info p6_wdt_info = {
 	.identity 	= DRV_NAME,
 	.options 	= WDIOF_SETTIMEOUT |
+				WDIOF_PRETIMEOUT |
 				WDIOF_KEEPALIVEPING |
 				WDIOF_MAGICCLOSE,
 };
@@ -207,6 +340,19 @@ static long p6_wdt_ioctl(struct file *file,
 	case WDIOC_GETTIMEOUT:
 		return put_user(wdt_time, p);
 
+	case WDIOC_SETPRETIMEOUT:
+		if (get_user(new_value, p))
+			return -EFAULT;
+
+		if (p6_wdt_setpretimeout(new_value))
+			return -EINVAL;
+
+		p6_wdt_pet();
+		return 0;
+
+	case WDIOC_GETPRETIMEOUT:
+		return put_user(pretimeout, p);
+
 	default:
 		return -ENOTTY;
 	}
@@ -241,8 +387,9 @@ static struct notifier_block p6_wdt_notifier = {
 
 static int __init p6_wdt_init(void)
 {
-	int ret;
+	int ret, new_pretimeout = pretimeout;
 
+	pretimeout = 0;
 	if (p6_wdt_settimeout(wdt_time)) {
 		p6_wdt_settimeout(WDT_DEFAULT_TIME);
 		printk(KERN_INFO DRV_NAME ": "
@@ -250,19 +397,35 @@ static int __init p6_wdt_init(void)
 			(WDT_MAX_TIME + 1), wdt_time);
 	}
 
-	ret = register_reboot_notifier(&p6_wdt_notifier);
+	if (p6_wdt_setpretimeout(new_pretimeout))
+		printk(KERN_INFO DRV_NAME ": "
+			"pretimeout must be lower than wdt_time, disabled\n");
+
+	pretimeout_rate = clk_get_rate(NULL)/4096;
+	__raw_writel(0, PARROT6_VA_SYS+_P6_SYS_TIM0CTL);
+
+	ret = request_irq(IRQ_P6_TIMER0, p6_wdt_pretimeout_interrupt,
+			  IRQF_DISABLED, DRV_NAME, NULL);
 	if (ret)
 		return ret;
 
+	ret = register_reboot_notifier(&p6_wdt_notifier);
+	if (ret)
+		goto noreboot;
+
 	ret = misc_register(&p6_wdt_miscdev);
-	if (ret) {
-		unregister_reboot_notifier(&p6_wdt_notifier);
-		return ret;
-	}
+	if (ret)
+		goto nomisc;
 
 	printk(KERN_INFO "P6 Watchdog driver loaded default (%d seconds%s)\n",
 				wdt_time, nowayout ? ", nowayout" : "");
 	return 0;
+
+nomisc:
+	unregister_reboot_notifier(&p6_wdt_notifier);
+noreboot:
+	free_irq(IRQ_P6_TIMER0, NULL);
+	return ret;
 }
 
 static void __exit p6_wdt_exit(void)
@@ -273,6 +436,7 @@ static void __exit p6_wdt_exit(void)
 	misc_deregister(&p6_wdt_miscdev);
 
 	unregister_reboot_notifier(&p6_wdt_notifier);
+	free_irq(IRQ_P6_TIMER0, NULL);
 }
 
 module_init(p6_wdt_init);
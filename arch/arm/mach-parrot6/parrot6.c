@@ -349,7 +349,7 @@ void __init p6_init(void)
 	__raw_writel(0x03030303, PARROT6_VA_MPMC+0x34);
 
 	/* power management default operator */
-	suspend_set_ops(&parrot6_pm_ops_never);
+	suspend_set_ops(&parrot6_pm_ops_mem);
 }
 
 void __init p6_map_io(void)
@@ -360,7 +360,8 @@ void __init p6_map_io(void)
 
 void __init p6_init_irq(void)
 {
-	vic_init(__io(PARROT6_VA_VIC), 0, ~0, 0);
+	/* only GPIO interrupts can wake up the system from suspend */
+	vic_init(__io(PARROT6_VA_VIC), 0, ~0, 1 << IRQ_P6_GPIO);
 }
 
 
@@ -119,7 +119,13 @@ struct p6i_usb2_platform_data_s p6i_usb2_platform_data = {
 	.operating_mode = P6P_USB2_DR_HOST,
 	.phy_mode       = P6P_USB2_PHY_UTMI,
 	.port_enables   = 1,
-	.force_full_speed = 0
+	.force_full_speed = 0,
+	/* bulk throughput: 1 irq per 1ms frame, 64 bytes bursts */
+	.irq_thresh	= 8,
+	.ahb_burst	= P6P_USB2_AHB_INCR16,
+	.tx_burst	= 16,
+	.rx_burst	= 16,
+	.tx_fifo_thres	= 4,
 };
 
 #define _F(_type)   _PL080_CXCONFIG_FLOWCNTRL_ ## _type
@@ -458,7 +464,7 @@ void __init p6i_init(void)
 	p6_sdhci0_device.dev.platform_data = &p6i_mmc_platform_data;
 
 	/* power management default operator */
-	suspend_set_ops(&parrot6_pm_ops_never);
+	suspend_set_ops(&parrot6_pm_ops_mem);
 
 	/* ldo enable */
 	__raw_writel(__raw_readl(PARROT6I_VA_RTC+_RTC_PWR_CTRL) | RTC_PWR_CTRL_CODEC_2v8_n3v0, PARROT6I_VA_RTC+_RTC_PWR_CTRL);
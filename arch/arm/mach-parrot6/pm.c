@@ -1,6 +1,8 @@
-/* arch/arm/mach-msm/pm.c
+/* arch/arm/mach-parrot6/pm.c
  *
- * Goldfish Power Management Routines
+ * Parrot6 Power Management Routines
+ *
+ * Based on the Goldfish power management routines.
  *
  * Copyright (C) 2007 Google, Inc.
  *
@@ -20,14 +22,125 @@
 #include <linux/init.h>
 #include <linux/pm.h>
 #include <linux/suspend.h>
+#include <linux/sched.h>
+#include <linux/math64.h>
+#include <linux/slab.h>
+
+#include <asm/io.h>
+#include <asm/cacheflush.h>
+#include <asm/mach/map.h>
+
 #include <mach/system.h>
+#include <mach/platform.h>
+#include <mach/map.h>
+#include <mach/parrot.h>
+#include <mach/gpio_parrot.h>
+
+#include "pm.h"
+
+/*
+ * Note on Parrot6 suspend-to-RAM:
+ *
+ * SDRAM is put in self-refresh by a small routine running from internal
+ * RAM, after all clock domains except the ones needed to wake up (ARM,
+ * bus matrix, MPMC and GPIO) have been gated. Only GPIO interrupts
+ * enabled as wake-up sources with enable_irq_wake() can resume the
+ * system; other GPIO sources are disabled while suspended.
+ *
+ * The PLL is left untouched: it can only be switched between two
+ * frequencies through a WFI handshake, and all timers derive from it.
+ *
+ * Internal RAM is not reserved for that routine: drivers (p264) and
+ * /dev/mem users may use it. Its first bytes are saved, the routine is
+ * copied there on each suspend, and the saved contents are put back on
+ * resume.
+ */
+
+/* clock domains left running in suspend-to-RAM */
+#define P6_PM_KEEP_CLOCKS      (P6_SYS_CLK_ARM|P6_SYS_CLK_BUSMX|	\
+				P6_SYS_CLK_MPMC|P6_SYS_CLK_GPIO)
+
+extern void parrot6_cpu_suspend(void __iomem *mpmc);
+extern unsigned int parrot6_cpu_suspend_sz;
+
+static void __iomem *parrot6_sram;
+static void *parrot6_sram_save;
+
+/* sched_clock() timestamp taken when leaving self-refresh */
+static unsigned long long parrot6_pm_wake_ns;
+
+static unsigned int resume_latency_us;
+module_param(resume_latency_us, uint, S_IRUGO);
+MODULE_PARM_DESC(resume_latency_us,
+		 "time spent resuming from last suspend-to-RAM (us)");
+
+static void parrot6_pm_suspend_mem(void)
+{
+	void (*sram_suspend)(void __iomem *mpmc) =
+		(void (*)(void __iomem *))parrot6_sram;
+	u32 cstat, psd_cstat = 0;
+
+	memcpy_fromio(parrot6_sram_save, parrot6_sram, parrot6_cpu_suspend_sz);
+	memcpy_toio(parrot6_sram, parrot6_cpu_suspend, parrot6_cpu_suspend_sz);
+	flush_icache_range((unsigned long)parrot6_sram,
+			   (unsigned long)parrot6_sram + parrot6_cpu_suspend_sz);
+
+	parrot_gpio_suspend();
+
+	cstat = __raw_readl(PARROT6_VA_SYS+_P6_SYS_CSTAT);
+	__raw_writel(cstat & ~P6_PM_KEEP_CLOCKS, PARROT6_VA_SYS+_P6_SYS_CDIS);
+	if (parrot_chip_is_p6()) {
+		psd_cstat = __raw_readl(PARROT6_VA_SYS+_P6_SYS_PSD_CSTAT);
+		__raw_writel(psd_cstat, PARROT6_VA_SYS+_P6_SYS_PSD_CDIS);
+	}
+
+	flush_cache_all();
+	sram_suspend(__io(PARROT6_VA_MPMC));
+	parrot6_pm_wake_ns = sched_clock();
+
+	if (parrot_chip_is_p6())
+		__raw_writel(psd_cstat, PARROT6_VA_SYS+_P6_SYS_PSD_CEN);
+	__raw_writel(cstat, PARROT6_VA_SYS+_P6_SYS_CEN);
+
+	parrot_gpio_resume();
+
+	memcpy_toio(parrot6_sram, parrot6_sram_save, parrot6_cpu_suspend_sz);
+}
 
 static int parrot6_pm_enter(suspend_state_t state)
 {
-	arch_idle();
+	switch (state) {
+	case PM_SUSPEND_MEM:
+		parrot6_pm_suspend_mem();
+		break;
+	default:
+		arch_idle();
+		break;
+	}
 	return 0;
 }
 
+static int parrot6_pm_prepare(void)
+{
+	/* drivers enable their wake-up interrupts in their suspend hook */
+	if (!parrot_gpio_wake_sources()) {
+		printk(KERN_ERR "PM: no wake-up source, not suspending\n");
+		return -EINVAL;
+	}
+	return 0;
+}
+
+static void parrot6_pm_end(void)
+{
+	if (!parrot6_pm_wake_ns)
+		return;
+
+	resume_latency_us = (unsigned int)div_u64(sched_clock() -
+						  parrot6_pm_wake_ns, 1000);
+	parrot6_pm_wake_ns = 0;
+	printk(KERN_INFO "PM: resumed in %u us\n", resume_latency_us);
+}
+
 static int parrot6_never_suspend(suspend_state_t state)
 {
 	return 0;
@@ -35,7 +148,7 @@ static int parrot6_never_suspend(suspend_state_t state)
 
 static int parrot6_suspend_valid_only_mem(suspend_state_t state)
 {
-	return state == PM_SUSPEND_MEM;
+	return (state == PM_SUSPEND_MEM) && (parrot6_sram != NULL);
 }
 
 struct platform_suspend_ops parrot6_pm_ops_never = {
@@ -44,16 +157,30 @@ struct platform_suspend_ops parrot6_pm_ops_never = {
 };
 
 struct platform_suspend_ops parrot6_pm_ops_mem = {
-	.enter		= parrot6_pm_enter,
 	.valid		= parrot6_suspend_valid_only_mem,
+	.prepare	= parrot6_pm_prepare,
+	.enter		= parrot6_pm_enter,
+	.end		= parrot6_pm_end,
 };
 
-
-/*static int __init parrot6_pm_init(void)
+static int __init parrot6_pm_init(void)
 {
-	suspend_set_ops(&parrot6_pm_ops);
+	void __iomem *sram;
+
+	parrot6_sram_save = kmalloc(parrot6_cpu_suspend_sz, GFP_KERNEL);
+	if (parrot6_sram_save == NULL)
+		return -ENOMEM;
+
+	sram = __arm_ioremap(PARROT6_INTRAM_BASE, PAGE_SIZE,
+			     MT_MEMORY_NONCACHED);
+	if (sram == NULL) {
+		printk(KERN_ERR "PM: cannot map internal RAM\n");
+		kfree(parrot6_sram_save);
+		return -ENOMEM;
+	}
+	parrot6_sram = sram;
+
 	return 0;
 }
 
-__initcall(parrot6_pm_init);
-*/
+late_initcall(parrot6_pm_init);
@@ -30,6 +30,7 @@
 #include <linux/clk.h>
 #include <linux/reboot.h>
 #include <linux/memblock.h>
+#include <linux/ramoops.h>
 
 /* Functions to sleep */
 #include <linux/delay.h>
@@ -348,12 +349,6 @@ static __init void powerup_reset_pwms(void)
 /* reserved RAM used to store oops/panic logs */
 #define RAMOOPS_SIZE  SZ_512K
 
-struct ramoops_platform_data {
-	unsigned long   mem_size;
-	unsigned long   mem_address;
-	int	            dump_oops;
-};
-
 static struct ramoops_platform_data ramoops_data = {
 	/* size of the persistent RAM allocated to ramoop */
 	.mem_size               = RAMOOPS_SIZE,
@@ -373,8 +368,13 @@ static void __init powerup_reserve_mem(void)
 	ramoops_data.mem_address = meminfo.bank[0].start +
 		meminfo.bank[0].size - RAMOOPS_SIZE;
 
-	memblock_reserve(&ramoops_data.mem_address,
-			&ramoops_data.mem_size);
+	/*
+	 * Reserved so that the kernel never uses it, and removed from the
+	 * memory map so that ramoops can ioremap() it uncached: records
+	 * must reach the SDRAM before a watchdog reset.
+	 */
+	memblock_reserve(ramoops_data.mem_address, ramoops_data.mem_size);
+	memblock_remove(ramoops_data.mem_address, ramoops_data.mem_size);
 }
 
 static void __init powerup_ramoops_init(void)
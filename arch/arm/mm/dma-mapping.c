@@ -17,6 +17,7 @@
 #include <linux/init.h>
 #include <linux/device.h>
 #include <linux/dma-mapping.h>
+#include <linux/dma-contiguous.h>
 
 #include <asm/memory.h>
 #include <asm/highmem.h>
@@ -77,16 +78,31 @@ static struct page *__dma_alloc_buffer(struct device *dev, size_t size, gfp_t gf
 	if (mask < 0xffffffffULL)
 		gfp |= GFP_DMA;
 
-	page = alloc_pages(gfp, order);
-	if (!page)
-		return NULL;
-
 	/*
-	 * Now split the huge page and free the excess pages
+	 * Large buffers are taken from the contiguous region first: the
+	 * buddy allocator seldom has such blocks left after a long uptime.
+	 * This may migrate pages, so only do it when we are allowed to sleep.
 	 */
-	split_page(page, order);
-	for (p = page + (size >> PAGE_SHIFT), e = page + (1 << order); p < e; p++)
-		__free_page(p);
+	page = NULL;
+#ifdef CONFIG_CMA
+	if (order >= CONFIG_CMA_MIN_ORDER &&
+	    (gfp & __GFP_WAIT) && !(gfp & GFP_DMA))
+		page = dma_alloc_from_contiguous(dev, size >> PAGE_SHIFT,
+						 order);
+#endif
+
+	if (!page) {
+		page = alloc_pages(gfp, order);
+		if (!page)
+			return NULL;
+
+		/*
+		 * Now split the huge page and free the excess pages
+		 */
+		split_page(page, order);
+		for (p = page + (size >> PAGE_SHIFT), e = page + (1 << order); p < e; p++)
+			__free_page(p);
+	}
 
 	/*
 	 * Ensure that the allocated pages are zeroed, and that any data
@@ -107,6 +123,9 @@ static void __dma_free_buffer(struct page *page, size_t size)
 {
 	struct page *e = page + (size >> PAGE_SHIFT);
 
+	if (dma_release_from_contiguous(NULL, page, size >> PAGE_SHIFT))
+		return;
+
 	while (page < e) {
 		__free_page(page);
 		page++;
@@ -18,6 +18,7 @@
 #include <linux/highmem.h>
 #include <linux/gfp.h>
 #include <linux/memblock.h>
+#include <linux/dma-contiguous.h>
 
 #include <asm/mach-types.h>
 #include <asm/sections.h>
@@ -297,6 +298,9 @@ void __init arm_memblock_init(struct meminfo *mi, struct machine_desc *mdesc)
 	if (mdesc->reserve)
 		mdesc->reserve();
 
+	/* contiguous DMA region, lent to movable pages while unused */
+	dma_contiguous_reserve();
+
 	memblock_analyze();
 	memblock_dump_all();
 }
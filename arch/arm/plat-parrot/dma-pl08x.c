@@ -31,6 +31,8 @@
 #include <mach/dma-pl08x.h>
 #include <mach/regs-pl08x.h>
 
+#include <trace/events/parrot.h>
+
 #define PL080_TIMEOUT           (1000)
 
 struct pl08x_dma_channel {
@@ -81,6 +83,8 @@ static irqreturn_t pl08x_dma_irq(int irq, void *dev_id)
 
 		if (chan_tc || chan_err) {
 			chan = &dmac.chan[i];
+			trace_pl08x_complete(i, chan->devid ? chan->devid : "",
+					     chan_err);
 			if (chan->busy && chan->callback) {
 				chan->callback(i, chan->data, chan_err);
 			}
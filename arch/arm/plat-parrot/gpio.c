@@ -50,6 +50,8 @@ struct gpio_src {
 static struct {
 	struct gpio_src		src[_P6_GPIO_INTC_COUNT];
 	u32			rot_status;
+	u32			wake_srcs;	/* sources allowed to wake up */
+	u32			saved_ena;	/* sources masked on suspend */
 } pgpio;
 
 const uint32_t p6_irq_mode[] = {
@@ -408,12 +410,80 @@ gpio_irq_type(unsigned int irq, unsigned int type)
 	return 0;
 }
 
+/*
+ * All GPIO sources share a single VIC line: remember which sources are
+ * wake-up sources, and forward the request to the VIC so that the GPIO
+ * line stays enabled while suspended.
+ */
+static int gpio_irq_set_wake(unsigned int irq, unsigned int on)
+{
+	u32 mask;
+	unsigned long flags;
+
+	if (irq <= IRQ_GPIO_END)
+		mask = 1 << (irq - IRQ_GPIO_START);
+	else
+		mask = 3 << (2*(irq - IRQ_ROTATOR_START));
+
+	local_irq_save(flags);
+	if (on)
+		pgpio.wake_srcs |= mask;
+	else
+		pgpio.wake_srcs &= ~mask;
+	local_irq_restore(flags);
+
+	return set_irq_wake(IRQ_GPIO, on);
+}
+
+/*
+ * Called with interrupts disabled, right before entering suspend:
+ * disable all GPIO interrupt sources which are not wake-up sources,
+ * so that they cannot bring the system out of suspend.
+ */
+void parrot_gpio_suspend(void)
+{
+	unsigned int src;
+	void __iomem *addr;
+	u32 reg;
+
+	pgpio.saved_ena = 0;
+	for (src = 0; src < _P6_GPIO_INTC_COUNT; src++) {
+		if (pgpio.wake_srcs & (1 << src))
+			continue;
+		addr = (void __iomem *) PARROT_VA_GPIO + _P6_GPIO_INTC1 + src*4;
+		reg = __raw_readl(addr);
+		if (reg & _P6_GPIO_INTCX_ENA) {
+			pgpio.saved_ena |= 1 << src;
+			__raw_writel(reg & ~_P6_GPIO_INTCX_ENA, addr);
+		}
+	}
+}
+
+/* Called with interrupts disabled, right after resume */
+void parrot_gpio_resume(void)
+{
+	unsigned int src;
+
+	for (src = 0; src < _P6_GPIO_INTC_COUNT; src++)
+		if (pgpio.saved_ena & (1 << src))
+			gpio_unmask_interrupt(src);
+
+	pgpio.saved_ena = 0;
+}
+
+/* Return a mask of GPIO interrupt sources which are wake-up sources */
+u32 parrot_gpio_wake_sources(void)
+{
+	return pgpio.wake_srcs;
+}
+
 static struct irq_chip vchip = {
 	.name		= "p6-gpio",
 	.ack		= gpio_irq_ack,
 	.mask		= gpio_irq_mask,
 	.unmask		= gpio_irq_unmask,
 	.set_type	= gpio_irq_type,
+	.set_wake	= gpio_irq_set_wake,
 };
 
 /* Select GPIO multiplexing */
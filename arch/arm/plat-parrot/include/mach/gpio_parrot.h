@@ -87,4 +87,9 @@ int gpio_interrupt_unregister(unsigned gpio);
 
 enum ROTATOR_EVENT_TAG rotator_get_status(unsigned int rot);
 
+/* power management helpers */
+void parrot_gpio_suspend(void);
+void parrot_gpio_resume(void);
+u32 parrot_gpio_wake_sources(void);
+
 #endif
@@ -97,6 +97,16 @@
 
 /* Registers bitwise definitions */
 
+/* Status Register */
+#define _Status_Busy                    (1 << 0)
+#define _Status_WriteBuffer             (1 << 1)
+#define _Status_SelfRefreshAck          (1 << 2)
+
+/* DynamicControl Register */
+#define _DynamicControl_ClockEnable     (1 << 0)
+#define _DynamicControl_ClockStop       (1 << 1)
+#define _DynamicControl_SelfRefresh     (1 << 2)
+
 /* StaticConfig Register */
 #define _StaticConfig_8bit              0
 #define _StaticConfig_16bit             (1 << 0)
@@ -40,12 +40,25 @@ enum p6i_usb2_phy_modes {
 	P6P_USB2_PHY_SERIAL,
 };
 
+/* AHB master burst types, SBUSCFG value + 1 so that 0 is the default */
+#define P6P_USB2_AHB_INCR		1	/* unspecified length */
+#define P6P_USB2_AHB_INCR4		6	/* aligned INCR4 */
+#define P6P_USB2_AHB_INCR8		7	/* aligned INCR8 */
+#define P6P_USB2_AHB_INCR16		8	/* aligned INCR16 */
+
 struct p6i_usb2_platform_data_s {
 	/* board specific information */
 	enum p6i_usb2_operating_modes	operating_mode;
 	enum p6i_usb2_phy_modes		phy_mode;
 	unsigned int			port_enables;
 	unsigned int			force_full_speed;
+
+	/* host controller tuning, 0 keeps the hardware default */
+	unsigned int			irq_thresh;	/* microframes per interrupt: 1, 2, 4 ... 64 */
+	unsigned int			ahb_burst;	/* SBUSCFG AHB burst type, P6P_USB2_AHB_* */
+	unsigned int			tx_burst;	/* TX burst length, 32 bit words */
+	unsigned int			rx_burst;	/* RX burst length, 32 bit words */
+	unsigned int			tx_fifo_thres;	/* TX FIFO fill before transmit, bursts */
 };
 
 #endif /* __ARCH_ARM_PARROT_REGS_P6P_H */
@@ -0,0 +1,257 @@
+/*
+ * Contiguous Memory Allocator for DMA buffers
+ *
+ * A physically contiguous region is reserved from memblock at boot. Once
+ * the page allocator is up, its pageblocks are given to the buddy
+ * allocator as MIGRATE_CMA, so that movable allocations can use them
+ * while no device does. Allocating a DMA buffer migrates the borrowed
+ * pages out of the requested range with alloc_contig_range().
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License or (at your optional) any later version of the license.
+ */
+
+#define pr_fmt(fmt) "cma: " fmt
+
+#include <linux/kernel.h>
+#include <linux/init.h>
+#include <linux/device.h>
+#include <linux/module.h>
+#include <linux/mm.h>
+#include <linux/mmzone.h>
+#include <linux/gfp.h>
+#include <linux/slab.h>
+#include <linux/mutex.h>
+#include <linux/bitmap.h>
+#include <linux/memblock.h>
+#include <linux/debugfs.h>
+#include <linux/ktime.h>
+#include <linux/dma-contiguous.h>
+
+struct cma {
+	unsigned long	base_pfn;
+	unsigned long	count;
+	unsigned long	*bitmap;
+	struct mutex	lock;
+
+	/* statistics, in pages and microseconds */
+	u32		total;
+	u32		used;
+	u32		peak;
+	u32		allocs;
+	u32		fails;
+	u32		last_alloc_us;
+	u32		max_alloc_us;
+};
+
+static struct cma cma_area;
+
+static unsigned long size_cmdline = -1;
+static phys_addr_t cma_base;
+static unsigned long cma_size;
+
+static int __init early_cma(char *p)
+{
+	size_cmdline = memparse(p, &p);
+	return 0;
+}
+early_param("cma", early_cma);
+
+/**
+ * dma_contiguous_reserve() - reserve the contiguous region from memblock
+ *
+ * Called by the architecture once memblock knows about all memory and all
+ * board specific reservations have been made. The size comes from the
+ * "cma=" kernel parameter, or from CONFIG_CMA_SIZE_MBYTES.
+ */
+void __init dma_contiguous_reserve(void)
+{
+	unsigned long align = PAGE_SIZE << max(MAX_ORDER - 1, pageblock_order);
+	unsigned long size;
+	u64 base;
+
+	if (size_cmdline != -1)
+		size = size_cmdline;
+	else
+		size = CONFIG_CMA_SIZE_MBYTES << 20;
+
+	if (!size)
+		return;
+
+	size = ALIGN(size, align);
+	base = __memblock_alloc_base(size, align, 0);
+	if (!base) {
+		pr_err("failed to reserve %ld MiB\n", size >> 20);
+		return;
+	}
+
+	cma_base = base;
+	cma_size = size;
+	pr_info("reserved %ld MiB at %08lx\n", size >> 20,
+		(unsigned long)base);
+}
+
+#ifdef CONFIG_DEBUG_FS
+static void __init cma_debugfs_init(struct cma *cma)
+{
+	struct dentry *dir;
+
+	dir = debugfs_create_dir("cma", NULL);
+	if (!dir)
+		return;
+
+	debugfs_create_u32("total", S_IRUGO, dir, &cma->total);
+	debugfs_create_u32("used", S_IRUGO, dir, &cma->used);
+	debugfs_create_u32("peak", S_IRUGO, dir, &cma->peak);
+	debugfs_create_u32("allocs", S_IRUGO, dir, &cma->allocs);
+	debugfs_create_u32("fails", S_IRUGO, dir, &cma->fails);
+	debugfs_create_u32("last_alloc_us", S_IRUGO, dir, &cma->last_alloc_us);
+	debugfs_create_u32("max_alloc_us", S_IRUGO, dir, &cma->max_alloc_us);
+}
+#else
+static inline void cma_debugfs_init(struct cma *cma) { }
+#endif
+
+static int __init cma_init_reserved_areas(void)
+{
+	struct cma *cma = &cma_area;
+	unsigned long pfn, end_pfn;
+	struct zone *zone;
+
+	if (!cma_size)
+		return 0;
+
+	cma->base_pfn = PFN_DOWN(cma_base);
+	cma->count = cma_size >> PAGE_SHIFT;
+	cma->bitmap = kzalloc(BITS_TO_LONGS(cma->count) * sizeof(long),
+			      GFP_KERNEL);
+	if (!cma->bitmap)
+		return -ENOMEM;
+	mutex_init(&cma->lock);
+
+	/* alloc_contig_range() works on a single zone */
+	end_pfn = cma->base_pfn + cma->count;
+	zone = page_zone(pfn_to_page(cma->base_pfn));
+	for (pfn = cma->base_pfn; pfn < end_pfn; pfn++) {
+		WARN_ON_ONCE(!pfn_valid(pfn));
+		if (page_zone(pfn_to_page(pfn)) != zone) {
+			pr_err("region crosses a zone boundary\n");
+			kfree(cma->bitmap);
+			cma->count = 0;
+			return -EINVAL;
+		}
+	}
+
+	for (pfn = cma->base_pfn; pfn < end_pfn; pfn += pageblock_nr_pages)
+		init_cma_reserved_pageblock(pfn_to_page(pfn));
+	cma->total = cma->count;
+
+	cma_debugfs_init(cma);
+	return 0;
+}
+core_initcall(cma_init_reserved_areas);
+
+/**
+ * dma_alloc_from_contiguous() - allocate pages from the contiguous region
+ * @dev:   Pointer to device for which the allocation is performed.
+ * @count: Requested number of pages.
+ * @order: Requested alignment, as a page order.
+ *
+ * Pages currently lent to the page allocator are migrated away, which may
+ * sleep. Returns NULL if the region cannot provide the buffer.
+ */
+struct page *dma_alloc_from_contiguous(struct device *dev, int count,
+				       unsigned int order)
+{
+	struct cma *cma = &cma_area;
+	unsigned long mask, pageno, start = 0;
+	struct page *page = NULL;
+	ktime_t t0;
+	u32 us;
+	int ret;
+
+	if (!cma->count || count <= 0)
+		return NULL;
+
+	if (order > MAX_ORDER - 1)
+		order = MAX_ORDER - 1;
+	mask = (1UL << order) - 1;
+
+	t0 = ktime_get();
+	mutex_lock(&cma->lock);
+
+	for (;;) {
+		pageno = bitmap_find_next_zero_area(cma->bitmap, cma->count,
+						    start, count, mask);
+		if (pageno >= cma->count)
+			break;
+
+		ret = alloc_contig_range(cma->base_pfn + pageno,
+					 cma->base_pfn + pageno + count,
+					 MIGRATE_CMA);
+		if (ret == 0) {
+			bitmap_set(cma->bitmap, pageno, count);
+			page = pfn_to_page(cma->base_pfn + pageno);
+			break;
+		} else if (ret != -EBUSY) {
+			break;
+		}
+		/* some page in the range is pinned: try further on */
+		start = pageno + mask + 1;
+	}
+
+	us = ktime_to_us(ktime_sub(ktime_get(), t0));
+	if (page) {
+		cma->allocs++;
+		cma->used += count;
+		if (cma->used > cma->peak)
+			cma->peak = cma->used;
+		cma->last_alloc_us = us;
+		if (us > cma->max_alloc_us)
+			cma->max_alloc_us = us;
+	} else {
+		cma->fails++;
+	}
+
+	mutex_unlock(&cma->lock);
+
+	if (!page)
+		dev_dbg(dev, "cma: failed to allocate %d pages\n", count);
+	return page;
+}
+
+/**
+ * dma_release_from_contiguous() - release pages to the contiguous region
+ * @dev:   Pointer to device for which the pages were allocated.
+ * @pages: Allocated pages.
+ * @count: Number of allocated pages.
+ *
+ * Returns non-zero if the pages belonged to the region and were released,
+ * zero otherwise, in which case the caller still owns them.
+ */
+int dma_release_from_contiguous(struct device *dev, struct page *pages,
+				int count)
+{
+	struct cma *cma = &cma_area;
+	unsigned long pfn;
+
+	if (!cma->count || !pages)
+		return 0;
+
+	pfn = page_to_pfn(pages);
+	if (pfn < cma->base_pfn || pfn >= cma->base_pfn + cma->count)
+		return 0;
+
+	VM_BUG_ON(pfn + count > cma->base_pfn + cma->count);
+
+	free_contig_range(pfn, count);
+
+	mutex_lock(&cma->lock);
+	bitmap_clear(cma->bitmap, pfn - cma->base_pfn, count);
+	cma->used -= count;
+	mutex_unlock(&cma->lock);
+
+	return 1;
+}
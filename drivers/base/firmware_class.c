@@ -20,6 +20,8 @@
 #include <linux/highmem.h>
 #include <linux/firmware.h>
 #include <linux/slab.h>
+#include <linux/fs.h>
+#include <linux/ktime.h>
 
 #define to_dev(obj) container_of(obj, struct device, kobj)
 
@@ -73,6 +75,105 @@ static inline bool fw_is_builtin_firmware(const struct firmware *fw)
 }
 #endif
 
+/* Some architectures don't have PAGE_KERNEL_RO */
+#ifndef PAGE_KERNEL_RO
+#define PAGE_KERNEL_RO PAGE_KERNEL
+#endif
+
+/* Direct loading from the root filesystem */
+
+#ifdef CONFIG_FW_LOADER_DIRECT
+
+static char fw_path[256] = CONFIG_FW_LOADER_DIRECT_PATH;
+module_param_string(path, fw_path, sizeof(fw_path), 0644);
+MODULE_PARM_DESC(path, "colon separated firmware search path");
+
+/* read @file into pages mapped the same way as a helper-loaded image */
+static bool fw_read_file(struct firmware *fw, struct file *file)
+{
+	loff_t size = i_size_read(file->f_path.dentry->d_inode);
+	struct page **pages;
+	loff_t pos = 0;
+	int nr_pages, i;
+
+	if (size <= 0 || size > INT_MAX)
+		return false;
+
+	nr_pages = PFN_UP(size);
+	pages = kcalloc(nr_pages, sizeof(*pages), GFP_KERNEL);
+	if (!pages)
+		return false;
+
+	for (i = 0; i < nr_pages; i++, pos += PAGE_SIZE) {
+		int len = min_t(loff_t, size - pos, PAGE_SIZE);
+		int ret;
+
+		pages[i] = alloc_page(GFP_KERNEL | __GFP_HIGHMEM);
+		if (!pages[i])
+			goto err;
+		ret = kernel_read(file, pos, kmap(pages[i]), len);
+		kunmap(pages[i]);
+		if (ret != len) {
+			i++;
+			goto err;
+		}
+	}
+
+	fw->data = vmap(pages, nr_pages, 0, PAGE_KERNEL_RO);
+	if (!fw->data)
+		goto err;
+	fw->pages = pages;
+	fw->size = size;
+	return true;
+
+err:
+	while (i--)
+		__free_page(pages[i]);
+	kfree(pages);
+	return false;
+}
+
+static bool fw_get_filesystem_firmware(struct firmware *fw, const char *name)
+{
+	const char *dir, *end;
+	char *file_name;
+	bool found = false;
+
+	file_name = __getname();
+	if (!file_name)
+		return false;
+
+	for (dir = fw_path; *dir && !found; dir = *end ? end + 1 : end) {
+		struct file *file;
+
+		end = strchr(dir, ':');
+		if (!end)
+			end = dir + strlen(dir);
+		if (end == dir)
+			continue;
+
+		snprintf(file_name, PATH_MAX, "%.*s/%s",
+			 (int)(end - dir), dir, name);
+		file = filp_open(file_name, O_RDONLY, 0);
+		if (IS_ERR(file))
+			continue;
+		found = fw_read_file(fw, file);
+		filp_close(file, NULL);
+	}
+
+	__putname(file_name);
+	return found;
+}
+
+#else
+
+static inline bool fw_get_filesystem_firmware(struct firmware *fw,
+					      const char *name)
+{
+	return false;
+}
+#endif
+
 enum {
 	FW_STATUS_LOADING,
 	FW_STATUS_DONE,
@@ -201,10 +302,6 @@ static void firmware_free_data(const struct firmware *fw)
 	}
 }
 
-/* Some architectures don't have PAGE_KERNEL_RO */
-#ifndef PAGE_KERNEL_RO
-#define PAGE_KERNEL_RO PAGE_KERNEL
-#endif
 /**
  * firmware_loading_store - set value in the 'loading' control file
  * @dev: device pointer
@@ -516,6 +613,7 @@ static int _request_firmware(const struct firmware **firmware_p,
 {
 	struct firmware_priv *fw_priv;
 	struct firmware *firmware;
+	ktime_t start = ktime_get();
 	int retval = 0;
 
 	if (!firmware_p)
@@ -534,6 +632,12 @@ static int _request_firmware(const struct firmware **firmware_p,
 		return 0;
 	}
 
+	if (fw_get_filesystem_firmware(firmware, name)) {
+		dev_info(device, "firmware: %s read directly in %lld us\n",
+			 name, ktime_us_delta(ktime_get(), start));
+		return 0;
+	}
+
 	if (uevent)
 		dev_dbg(device, "firmware: requesting %s\n", name);
 
@@ -565,6 +669,10 @@ static int _request_firmware(const struct firmware **firmware_p,
 
 	fw_destroy_instance(fw_priv);
 
+	if (!retval)
+		dev_info(device, "firmware: %s loaded by helper in %lld us\n",
+			 name, ktime_us_delta(ktime_get(), start));
+
 out:
 	if (retval) {
 		release_firmware(firmware);
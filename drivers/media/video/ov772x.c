@@ -20,6 +20,8 @@
 #include <linux/i2c.h>
 #include <linux/slab.h>
 #include <linux/delay.h>
+#include <linux/bitmap.h>
+#include <linux/ktime.h>
 #include <linux/videodev2.h>
 #include <media/v4l2-chip-ident.h>
 #include <media/v4l2-subdev.h>
@@ -408,6 +410,11 @@ struct ov772x_priv {
 	unsigned short                    flag_hflip:1;
 	/* band_filter = COM8[5] ? 256 - BDBASE : 0 */
 	unsigned short                    band_filter;
+	/* sensor registers as last read or written, cleared on reset */
+	u8                                reg_cache[0x100];
+	DECLARE_BITMAP(reg_cached, 0x100);
+	/* the sensor holds the win/cfmt configuration, no reset needed */
+	unsigned short                    flag_setup:1;
 };
 
 #define ENDMARKER { 0xff, 0xff }
@@ -557,13 +564,49 @@ static struct ov772x_priv *to_ov772x(const struct i2c_client *client)
 			    subdev);
 }
 
+static s32 ov772x_read(struct i2c_client *client, u8 reg)
+{
+	struct ov772x_priv *priv = to_ov772x(client);
+	s32 val;
+
+	if (test_bit(reg, priv->reg_cached))
+		return priv->reg_cache[reg];
+
+	val = i2c_smbus_read_byte_data(client, reg);
+	if (val >= 0) {
+		priv->reg_cache[reg] = val;
+		__set_bit(reg, priv->reg_cached);
+	}
+
+	return val;
+}
+
+/* only registers whose value differs from the cache go on the bus */
+static int ov772x_write(struct i2c_client *client, u8 reg, u8 val)
+{
+	struct ov772x_priv *priv = to_ov772x(client);
+	int ret;
+
+	if (test_bit(reg, priv->reg_cached) && priv->reg_cache[reg] == val)
+		return 0;
+
+	ret = i2c_smbus_write_byte_data(client, reg, val);
+	if (ret < 0) {
+		__clear_bit(reg, priv->reg_cached);
+		return ret;
+	}
+
+	priv->reg_cache[reg] = val;
+	__set_bit(reg, priv->reg_cached);
+
+	return 0;
+}
+
 static int ov772x_write_array(struct i2c_client        *client,
 			      const struct regval_list *vals)
 {
 	while (vals->reg_num != 0xff) {
-		int ret = i2c_smbus_write_byte_data(client,
-						    vals->reg_num,
-						    vals->value);
+		int ret = ov772x_write(client, vals->reg_num, vals->value);
 		if (ret < 0)
 			return ret;
 		vals++;
@@ -576,19 +619,25 @@ static int ov772x_mask_set(struct i2c_client *client,
 					  u8  mask,
 					  u8  set)
 {
-	s32 val = i2c_smbus_read_byte_data(client, command);
+	s32 val = ov772x_read(client, command);
 	if (val < 0)
 		return val;
 
 	val &= ~mask;
 	val |= set & mask;
 
-	return i2c_smbus_write_byte_data(client, command, val);
+	return ov772x_write(client, command, val);
 }
 
 static int ov772x_reset(struct i2c_client *client)
 {
-	int ret = i2c_smbus_write_byte_data(client, COM7, SCCB_RESET);
+	struct ov772x_priv *priv = to_ov772x(client);
+	int ret;
+
+	bitmap_zero(priv->reg_cached, 0x100);
+	priv->flag_setup = 0;
+
+	ret = i2c_smbus_write_byte_data(client, COM7, SCCB_RESET);
 	msleep(1);
 	return ret;
 }
@@ -748,11 +797,14 @@ static int ov772x_s_register(struct v4l2_subdev *sd,
 			     struct v4l2_dbg_register *reg)
 {
 	struct i2c_client *client = sd->priv;
+	struct ov772x_priv *priv = to_ov772x(client);
 
 	if (reg->reg > 0xff ||
 	    reg->val > 0xff)
 		return -EINVAL;
 
+	__clear_bit(reg->reg, priv->reg_cached);
+
 	return i2c_smbus_write_byte_data(client, reg->reg, reg->val);
 }
 #endif
@@ -780,6 +832,7 @@ static int ov772x_set_params(struct i2c_client *client, u32 *width, u32 *height,
 			     enum v4l2_mbus_pixelcode code)
 {
 	struct ov772x_priv *priv = to_ov772x(client);
+	ktime_t start = ktime_get();
 	int ret = -EINVAL;
 	u8  val;
 	int i;
@@ -803,8 +856,12 @@ static int ov772x_set_params(struct i2c_client *client, u32 *width, u32 *height,
 	priv->win = ov772x_select_win(*width, *height);
 
 	/*
-	 * reset hardware
+	 * reset hardware, unless it is already set up: only the registers
+	 * that differ from the current mode are then written below
 	 */
+	if (priv->flag_setup)
+		goto ov772x_set_mode;
+
 	ov772x_reset(client);
 
 	/*
@@ -854,6 +911,7 @@ static int ov772x_set_params(struct i2c_client *client, u32 *width, u32 *height,
 			goto ov772x_set_fmt_error;
 	}
 
+ov772x_set_mode:
 	/*
 	 * set size format
 	 */
@@ -865,12 +923,10 @@ static int ov772x_set_params(struct i2c_client *client, u32 *width, u32 *height,
 	 * set DSP_CTRL3
 	 */
 	val = priv->cfmt->dsp3;
-	if (val) {
-		ret = ov772x_mask_set(client,
-				      DSP_CTRL3, UV_MASK, val);
-		if (ret < 0)
-			goto ov772x_set_fmt_error;
-	}
+	ret = ov772x_mask_set(client,
+			      DSP_CTRL3, UV_MASK, val);
+	if (ret < 0)
+		goto ov772x_set_fmt_error;
 
 	/*
 	 * set COM3
@@ -904,7 +960,7 @@ static int ov772x_set_params(struct i2c_client *client, u32 *width, u32 *height,
 	 * set COM8
 	 */
 	if (priv->band_filter) {
-		ret = ov772x_mask_set(client, COM8, BNDF_ON_OFF, 1);
+		ret = ov772x_mask_set(client, COM8, BNDF_ON_OFF, BNDF_ON_OFF);
 		if (!ret)
 			ret = ov772x_mask_set(client, BDBASE,
 					      0xff, 256 - priv->band_filter);
@@ -915,6 +971,11 @@ static int ov772x_set_params(struct i2c_client *client, u32 *width, u32 *height,
 	*width = priv->win->width;
 	*height = priv->win->height;
 
+	dev_info(&client->dev, "%s mode set%s in %lld us\n", priv->win->name,
+		 priv->flag_setup ? "" : " after reset",
+		 ktime_us_delta(ktime_get(), start));
+	priv->flag_setup = 1;
+
 	return ret;
 
 ov772x_set_fmt_error:
@@ -1075,6 +1136,21 @@ static int ov772x_video_probe(struct soc_camera_device *icd,
 	return 0;
 }
 
+/*
+ * The sensor may have been powered off or reset by the board: forget its
+ * registers so that the next format set starts with a reset
+ */
+static int ov772x_s_power(struct v4l2_subdev *sd, int on)
+{
+	struct i2c_client *client = sd->priv;
+	struct ov772x_priv *priv = to_ov772x(client);
+
+	bitmap_zero(priv->reg_cached, 0x100);
+	priv->flag_setup = 0;
+
+	return 0;
+}
+
 static struct soc_camera_ops ov772x_ops = {
 	.set_bus_param		= ov772x_set_bus_param,
 	.query_bus_param	= ov772x_query_bus_param,
@@ -1086,6 +1162,7 @@ static struct v4l2_subdev_core_ops ov772x_subdev_core_ops = {
 	.g_ctrl		= ov772x_g_ctrl,
 	.s_ctrl		= ov772x_s_ctrl,
 	.g_chip_ident	= ov772x_g_chip_ident,
+	.s_power	= ov772x_s_power,
 #ifdef CONFIG_VIDEO_ADV_DEBUG
 	.g_register	= ov772x_g_register,
 	.s_register	= ov772x_s_register,
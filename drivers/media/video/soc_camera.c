@@ -390,6 +390,9 @@ static int soc_camera_open(struct file *file)
 			goto eiciadd;
 		}
 
+		/* Power and reset may have lost the sensor state */
+		v4l2_subdev_call(soc_camera_to_subdev(icd), core, s_power, 1);
+
 		pm_runtime_enable(&icd->vdev->dev);
 		ret = pm_runtime_resume(&icd->vdev->dev);
 		if (ret < 0 && ret != -ENOSYS)
@@ -422,6 +425,7 @@ static int soc_camera_open(struct file *file)
 esfmt:
 	pm_runtime_disable(&icd->vdev->dev);
 eresume:
+	v4l2_subdev_call(soc_camera_to_subdev(icd), core, s_power, 0);
 	ici->ops->remove(icd);
 eiciadd:
 	if (icl->power)
@@ -449,6 +453,7 @@ static int soc_camera_close(struct file *file)
 		pm_runtime_suspend(&icd->vdev->dev);
 		pm_runtime_disable(&icd->vdev->dev);
 
+		v4l2_subdev_call(soc_camera_to_subdev(icd), core, s_power, 0);
 		ici->ops->remove(icd);
 
 		if (icl->power)
@@ -1021,6 +1026,7 @@ static int soc_camera_probe(struct device *dev)
 			      "control"))
 		dev_warn(&icd->dev, "Failed creating the control symlink\n");
 
+	v4l2_subdev_call(sd, core, s_power, 0);
 	ici->ops->remove(icd);
 
 	if (icl->power)
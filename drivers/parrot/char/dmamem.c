@@ -20,6 +20,21 @@
 
 #include <linux/list.h>
 #include <linux/dma-mapping.h>
+#include <linux/mutex.h>
+#include <linux/wait.h>
+#include <linux/poll.h>
+#include <linux/sched.h>
+#include <linux/pagemap.h>
+#include <linux/pipe_fs_i.h>
+#include <linux/splice.h>
+#include <linux/workqueue.h>
+#include <linux/timer.h>
+#include <linux/net.h>
+#include <linux/in.h>
+#include <linux/skbuff.h>
+#include <net/sock.h>
+#include <net/dst.h>
+#include <net/udp.h>
 #include <asm/cacheflush.h>
 
 #include "dmamem_ioctl.h"
@@ -32,34 +47,287 @@ struct device   *dmamem_dev;
 struct dmamem_list {
 	struct  list_head list;
 	struct dmamem_alloc data;
+	/*
+	 * one for the owner, plus one per pipe buffer and per datagram
+	 * referencing the block. The block is freed with the last one.
+	 */
+	atomic_t refs;
+	/* sum of the page counts of the block when nobody else holds them */
+	int page_refs;
+	struct work_struct free_work;
 };
 
+/* completion of a datagram sent by DMAMEM_SEND */
+struct dmamem_ubuf {
+	struct ubuf_info ubuf;
+	struct dmamem_list *ldata;
+};
+
+struct dmamem_file {
+	struct list_head head;
+	/* block spliced by splice_read, set by DMAMEM_SPLICE_SELECT */
+	struct dmamem_list *splice_src;
+	struct mutex lock;
+};
+
+/* woken up each time a block becomes idle again */
+static DECLARE_WAIT_QUEUE_HEAD(dmamem_splice_wait);
+
+/*
+ * Pages spliced to a socket are held by the skbs built from them after
+ * the pipe released them, and nothing tells when these skbs are freed:
+ * busy blocks are checked again periodically.
+ */
+#define DMAMEM_IDLE_POLL_MS 10
+
+static void dmamem_idle_timeout(unsigned long data)
+{
+	wake_up_interruptible(&dmamem_splice_wait);
+}
+
+static DEFINE_TIMER(dmamem_idle_timer, dmamem_idle_timeout, 0, 0);
+
+static void dmamem_free(struct dmamem_list *ldata)
+{
+	struct dmamem_alloc *data = &ldata->data;
+
+	dma_free_coherent(dmamem_dev, data->size, data->cpu_addr, (dma_addr_t)data->phy_addr);
+	kfree(ldata);
+	module_put(THIS_MODULE);
+}
+
+static void dmamem_free_work(struct work_struct *work)
+{
+	dmamem_free(container_of(work, struct dmamem_list, free_work));
+}
+
+/*
+ * Drop a consumer reference. This runs when the stack frees a datagram,
+ * so possibly in softirq context: the block is freed from a work if the
+ * owner has already closed the fd.
+ */
+static void dmamem_put(struct dmamem_list *ldata)
+{
+	struct dmamem_alloc *data = &ldata->data;
+
+	switch (atomic_dec_return(&ldata->refs)) {
+	case 0:
+		schedule_work(&ldata->free_work);
+		break;
+	case 1:
+		/* idle again: the device may write the block */
+		dma_sync_single_for_device(dmamem_dev, (dma_addr_t)data->phy_addr,
+					   data->size, DMA_FROM_DEVICE);
+		wake_up_interruptible(&dmamem_splice_wait);
+		break;
+	}
+}
+
+/* sum of the page counts of the block, the stack holds one per frag */
+static int dmamem_page_refs(struct dmamem_list *ldata)
+{
+	unsigned long phys = (unsigned long)ldata->data.phy_addr;
+	unsigned long pfn = __phys_to_pfn(phys);
+	unsigned long last = __phys_to_pfn(phys + ldata->data.size - 1);
+	int refs = 0;
+
+	/* such a block can't be selected, so it is never spliced */
+	if (!pfn_valid(pfn))
+		return 0;
+
+	for (; pfn <= last; pfn++)
+		refs += page_count(pfn_to_page(pfn));
+	return refs;
+}
+
+/* no pipe buffer, datagram or skb refers to the block anymore */
+static int dmamem_block_idle(struct dmamem_list *ldata)
+{
+	if (atomic_read(&ldata->refs) != 1)
+		return 0;
+
+	if (dmamem_page_refs(ldata) != ldata->page_refs) {
+		mod_timer(&dmamem_idle_timer,
+			  jiffies + msecs_to_jiffies(DMAMEM_IDLE_POLL_MS));
+		return 0;
+	}
+	return 1;
+}
+
 static int dmamem_open(struct inode *inode, struct file *filp)
 {
-	struct  list_head *head;
+	struct dmamem_file *dfile;
 
-    head = kzalloc(sizeof(struct list_head), GFP_KERNEL);
-	INIT_LIST_HEAD(head);
+	dfile = kzalloc(sizeof(struct dmamem_file), GFP_KERNEL);
+	if (!dfile)
+		return -ENOMEM;
+	INIT_LIST_HEAD(&dfile->head);
+	mutex_init(&dfile->lock);
 
-    filp->private_data = head;
+    filp->private_data = dfile;
     return 0;
 }
 
 static int dmamem_release(struct inode *inode, struct file *filp)
 {
-	struct list_head *head = filp->private_data;
-	struct dmamem_list *ldata;
-
-	list_for_each_entry(ldata, head, list) {
-		struct dmamem_alloc *data = &ldata->data;
-		dma_free_coherent(dmamem_dev, data->size, data->cpu_addr, (dma_addr_t)data->phy_addr);
-		kfree(ldata);
+	struct dmamem_file *dfile = filp->private_data;
+	struct dmamem_list *ldata, *tmp;
+
+	list_for_each_entry_safe(ldata, tmp, &dfile->head, list) {
+		list_del(&ldata->list);
+		/* blocks still used by a consumer are freed by dmamem_put() */
+		if (atomic_dec_and_test(&ldata->refs))
+			dmamem_free(ldata);
 	}
-	kfree(head);
+	kfree(dfile);
     filp->private_data = NULL;
     return 0;
 }
 
+static struct dmamem_list *dmamem_find(struct dmamem_file *dfile,
+				       void *phy_addr)
+{
+	struct dmamem_list *ldata;
+
+	list_for_each_entry(ldata, &dfile->head, list)
+		if (ldata->data.phy_addr == phy_addr)
+			return ldata;
+	return NULL;
+}
+
+/* the last skb data area referring to the block pages is freed */
+static void dmamem_ubuf_callback(struct ubuf_info *ubuf)
+{
+	struct dmamem_ubuf *dubuf = container_of(ubuf, struct dmamem_ubuf, ubuf);
+
+	dmamem_put(dubuf->ldata);
+	kfree(dubuf);
+}
+
+/*
+ * Send part of the selected block as one UDP datagram. The block pages
+ * are appended to the corked socket, then the skb holding them gets a
+ * ubuf_info that releases the block once the stack dropped the pages,
+ * clones and copies included. It also keeps the skb from being orphaned
+ * before the device is done with it.
+ */
+static int dmamem_send(struct dmamem_file *dfile, struct dmamem_send *req)
+{
+	struct msghdr msg = { .msg_flags = 0 };
+	struct dmamem_list *ldata;
+	struct dmamem_ubuf *dubuf;
+	struct dst_entry *dst;
+	struct socket *sock;
+	struct sk_buff *skb;
+	struct sock *sk;
+	unsigned long phys;
+	unsigned int len;
+	int ret;
+
+	sock = sockfd_lookup(req->fd, &ret);
+	if (!sock)
+		return ret;
+	sk = sock->sk;
+	if (sk->sk_family != AF_INET || sk->sk_protocol != IPPROTO_UDP) {
+		ret = -EINVAL;
+		goto out;
+	}
+
+	/* without scatter-gather, udp_sendpage() silently copies the data */
+	dst = sk_dst_get(sk);
+	if (!dst) {
+		ret = -ENOTCONN;
+		goto out;
+	}
+	ret = dst->dev->features & NETIF_F_SG ? 0 : -EOPNOTSUPP;
+	dst_release(dst);
+	if (ret < 0)
+		goto out;
+
+	dubuf = kmalloc(sizeof(*dubuf), GFP_KERNEL);
+	if (!dubuf) {
+		ret = -ENOMEM;
+		goto out;
+	}
+
+	mutex_lock(&dfile->lock);
+	ldata = dfile->splice_src;
+	if (!ldata || req->len == 0 || req->offset >= ldata->data.size ||
+	    req->len > ldata->data.size - req->offset) {
+		mutex_unlock(&dfile->lock);
+		kfree(dubuf);
+		ret = -EINVAL;
+		goto out;
+	}
+	atomic_inc(&ldata->refs);
+	mutex_unlock(&dfile->lock);
+
+	dubuf->ubuf.callback = dmamem_ubuf_callback;
+	atomic_set(&dubuf->ubuf.refcnt, 1);
+	dubuf->ldata = ldata;
+
+	phys = (unsigned long)ldata->data.phy_addr + req->offset;
+	len = req->len;
+
+	/* the device wrote the data, the stack may read it from the cache */
+	dma_sync_single_for_cpu(dmamem_dev, phys, len, DMA_FROM_DEVICE);
+
+	while (len) {
+		unsigned int off = phys & ~PAGE_MASK;
+		unsigned int this_len = min_t(size_t, len, PAGE_SIZE - off);
+		struct page *page = pfn_to_page(__phys_to_pfn(phys));
+
+		/* a short write would leave a hole in the datagram */
+		ret = kernel_sendpage(sock, page, off, this_len, MSG_MORE);
+		if (ret != this_len) {
+			if (ret >= 0)
+				ret = -EIO;
+			goto out_flush;
+		}
+
+		phys += this_len;
+		len -= this_len;
+	}
+
+	lock_sock(sk);
+	/*
+	 * A datagram split in several IP fragments or GSO segments is
+	 * rebuilt from copies or new skbs that the ubuf_info doesn't
+	 * follow. The route may also have changed to a device without
+	 * scatter-gather since the check above, and the payload was
+	 * copied to the linear part.
+	 */
+	skb = skb_peek(&sk->sk_write_queue);
+	if (skb_queue_len(&sk->sk_write_queue) != 1 || skb_is_gso(skb)) {
+		ret = -EMSGSIZE;
+		goto out_flush_locked;
+	}
+	if (skb->data_len != req->len) {
+		ret = -EOPNOTSUPP;
+		goto out_flush_locked;
+	}
+	skb_shinfo(skb)->destructor_arg = &dubuf->ubuf;
+	skb_tx(skb)->dev_zerocopy = 1;
+	release_sock(sk);
+
+	/* push the datagram, the reference now belongs to the skb */
+	ret = kernel_sendmsg(sock, &msg, NULL, 0, 0);
+	if (ret >= 0)
+		ret = req->len;
+	goto out;
+
+out_flush:
+	lock_sock(sk);
+out_flush_locked:
+	udp_flush_pending_frames(sk);
+	release_sock(sk);
+	kfree(dubuf);
+	dmamem_put(ldata);
+out:
+	sockfd_put(sock);
+	return ret;
+}
+
 /* copied from arm/mm/trap.c */
 static inline void
 do_cache_op(unsigned long start, unsigned long end, int flags)
@@ -84,13 +352,13 @@ do_cache_op(unsigned long start, unsigned long end, int flags)
 static int dmamem_ioctl(struct inode *inode, struct file *filp,
         unsigned int cmd, unsigned long arg)
 {
+    struct dmamem_file *dfile = filp->private_data;
     int ret = 0;
 
     switch (cmd)
     {
         case DMAMEM_ALLOC:
 			{
-				struct  list_head *head = filp->private_data;
 				struct dmamem_list *ldata;
 				struct dmamem_alloc *data;
 				dma_addr_t dma_handle;
@@ -102,6 +370,8 @@ static int dmamem_ioctl(struct inode *inode, struct file *filp,
 					break;
 				}
 				INIT_LIST_HEAD(&ldata->list);
+				atomic_set(&ldata->refs, 1);
+				INIT_WORK(&ldata->free_work, dmamem_free_work);
 				data = &ldata->data;
 
 				if (copy_from_user(data, (void __user *)arg, sizeof(*data))) {
@@ -118,12 +388,18 @@ static int dmamem_ioctl(struct inode *inode, struct file *filp,
 				}
 				data->cpu_addr = cpu_addr;
 				data->phy_addr = (void *)dma_handle;
+				ldata->page_refs = dmamem_page_refs(ldata);
 				if (copy_to_user((void __user *)arg, data, sizeof(*data))) {
 					ret = -EFAULT;
+					dma_free_coherent(dmamem_dev, data->size, cpu_addr, dma_handle);
 					kfree(ldata);
 					break;
 				}
-				list_add_tail(&ldata->list, head);
+				/* in flight datagrams may outlive the fd */
+				__module_get(THIS_MODULE);
+				mutex_lock(&dfile->lock);
+				list_add_tail(&ldata->list, &dfile->head);
+				mutex_unlock(&dfile->lock);
 			}
             break;
         case DMAMEM_ARM_FLUSH_INV:
@@ -136,16 +412,192 @@ static int dmamem_ioctl(struct inode *inode, struct file *filp,
 				do_cache_op(data.start, data.start+data.len, 0);
 			}
 			break;
+        case DMAMEM_SPLICE_SELECT:
+        case DMAMEM_SPLICE_WAIT:
+			{
+				struct dmamem_alloc data;
+				struct dmamem_list *ldata;
+
+				if (copy_from_user(&data, (void __user *)arg, sizeof(data))) {
+					ret = -EFAULT;
+					break;
+				}
+				mutex_lock(&dfile->lock);
+				ldata = dmamem_find(dfile, data.phy_addr);
+				if (!ldata) {
+					mutex_unlock(&dfile->lock);
+					ret = -EINVAL;
+					break;
+				}
+				if (cmd == DMAMEM_SPLICE_SELECT) {
+					if (!pfn_valid(__phys_to_pfn((unsigned long)data.phy_addr)))
+						ret = -EINVAL;
+					else {
+						dfile->splice_src = ldata;
+						filp->f_pos = 0;
+					}
+					mutex_unlock(&dfile->lock);
+					break;
+				}
+				mutex_unlock(&dfile->lock);
+
+				ret = wait_event_interruptible(dmamem_splice_wait,
+						dmamem_block_idle(ldata));
+			}
+			break;
+        case DMAMEM_SEND:
+			{
+				struct dmamem_send data;
+
+				if (copy_from_user(&data, (void __user *)arg, sizeof(data))) {
+					ret = -EFAULT;
+					break;
+				}
+				ret = dmamem_send(dfile, &data);
+			}
+			break;
         default:
             ret = -ENOTTY;
     }
     return ret;
 }
 
+static void dmamem_pipe_buf_release(struct pipe_inode_info *pipe,
+				    struct pipe_buffer *buf)
+{
+	struct dmamem_list *ldata = (struct dmamem_list *)buf->private;
+
+	page_cache_release(buf->page);
+	dmamem_put(ldata);
+}
+
+static void dmamem_pipe_buf_get(struct pipe_inode_info *pipe,
+				struct pipe_buffer *buf)
+{
+	struct dmamem_list *ldata = (struct dmamem_list *)buf->private;
+
+	atomic_inc(&ldata->refs);
+	page_cache_get(buf->page);
+}
+
+/* the pages belong to the producer, they can never be stolen */
+static int dmamem_pipe_buf_steal(struct pipe_inode_info *pipe,
+				 struct pipe_buffer *buf)
+{
+	return 1;
+}
+
+static const struct pipe_buf_operations dmamem_pipe_buf_ops = {
+	.can_merge = 0,
+	.map = generic_pipe_buf_map,
+	.unmap = generic_pipe_buf_unmap,
+	.confirm = generic_pipe_buf_confirm,
+	.release = dmamem_pipe_buf_release,
+	.steal = dmamem_pipe_buf_steal,
+	.get = dmamem_pipe_buf_get,
+};
+
+static void dmamem_spd_release(struct splice_pipe_desc *spd, unsigned int i)
+{
+	page_cache_release(spd->pages[i]);
+	dmamem_put((struct dmamem_list *)spd->partial[i].private);
+}
+
+/*
+ * Hand the pages of the selected block to a pipe, without copying them.
+ * Spliced to a socket, they end up referenced by the skbs built from
+ * them: dmamem_block_idle() also checks the page counts, so that
+ * DMAMEM_SPLICE_WAIT tells when the producer may reuse the block.
+ */
+static ssize_t dmamem_splice_read(struct file *filp, loff_t *ppos,
+				  struct pipe_inode_info *pipe, size_t len,
+				  unsigned int flags)
+{
+	struct dmamem_file *dfile = filp->private_data;
+	struct page *pages[PIPE_DEF_BUFFERS];
+	struct partial_page partial[PIPE_DEF_BUFFERS];
+	struct splice_pipe_desc spd = {
+		.pages = pages,
+		.partial = partial,
+		.flags = flags,
+		.ops = &dmamem_pipe_buf_ops,
+		.spd_release = dmamem_spd_release,
+	};
+	struct dmamem_list *ldata;
+	unsigned long phys;
+	loff_t pos = *ppos;
+	ssize_t ret;
+
+	mutex_lock(&dfile->lock);
+	ldata = dfile->splice_src;
+	if (!ldata) {
+		mutex_unlock(&dfile->lock);
+		return -EINVAL;
+	}
+	if (pos >= ldata->data.size) {
+		mutex_unlock(&dfile->lock);
+		return 0;
+	}
+	if (len > ldata->data.size - pos)
+		len = ldata->data.size - pos;
+
+	if (splice_grow_spd(pipe, &spd)) {
+		mutex_unlock(&dfile->lock);
+		return -ENOMEM;
+	}
+
+	phys = (unsigned long)ldata->data.phy_addr + pos;
+
+	/* the device wrote the data, the consumer may read it from the cache */
+	dma_sync_single_for_cpu(dmamem_dev, phys, len, DMA_FROM_DEVICE);
+
+	while (len && spd.nr_pages < pipe->buffers) {
+		unsigned int off = phys & ~PAGE_MASK;
+		unsigned int this_len = min_t(size_t, len, PAGE_SIZE - off);
+		struct page *page = pfn_to_page(__phys_to_pfn(phys));
+
+		page_cache_get(page);
+		atomic_inc(&ldata->refs);
+		spd.pages[spd.nr_pages] = page;
+		spd.partial[spd.nr_pages].offset = off;
+		spd.partial[spd.nr_pages].len = this_len;
+		spd.partial[spd.nr_pages].private = (unsigned long)ldata;
+		spd.nr_pages++;
+
+		phys += this_len;
+		len -= this_len;
+	}
+	mutex_unlock(&dfile->lock);
+
+	ret = splice_to_pipe(pipe, &spd);
+	if (ret > 0)
+		*ppos += ret;
+
+	splice_shrink_spd(pipe, &spd);
+	return ret;
+}
+
+static unsigned int dmamem_poll(struct file *filp, poll_table *wait)
+{
+	struct dmamem_file *dfile = filp->private_data;
+	unsigned int mask = 0;
+
+	poll_wait(filp, &dmamem_splice_wait, wait);
+
+	mutex_lock(&dfile->lock);
+	if (dfile->splice_src && dmamem_block_idle(dfile->splice_src))
+		mask |= POLLOUT | POLLWRNORM;
+	mutex_unlock(&dfile->lock);
+
+	return mask;
+}
+
 struct file_operations dmamem_fops = {
     .ioctl =     dmamem_ioctl,
     .open =      dmamem_open,
     .release =   dmamem_release,
+    .splice_read = dmamem_splice_read,
+    .poll =      dmamem_poll,
 };
 
 static struct miscdevice dmamem_miscdev = {
@@ -200,6 +652,8 @@ static int dmamem_remove(struct platform_device *pdev)
      * this call is possible only if there is no user
      */
 	misc_deregister(&dmamem_miscdev);
+	del_timer_sync(&dmamem_idle_timer);
+	flush_scheduled_work();
 	dma_release_declared_memory(&pdev->dev);
     dev_info(&pdev->dev, "driver removed\n");
 
@@ -25,6 +25,12 @@ struct dmamem_flush_inv {
 	unsigned long len;
 };
 
+struct dmamem_send {
+	int fd; /* connected UDP socket */
+	unsigned int offset; /* offset in the selected block */
+	unsigned int len; /* datagram payload length */
+};
+
 #define DMAMEM_MAGIC 'p'
 /** DMAMEM_ALLOC
  * allocate dma memory and return physical adress
@@ -38,5 +44,34 @@ struct dmamem_flush_inv {
  * @see dmamem_alloc
  */
 #define DMAMEM_ARM_FLUSH_INV _IOWR(DMAMEM_MAGIC, 1, struct dmamem_flush_inv)
+/** DMAMEM_SPLICE_SELECT
+ * select the block, allocated on the same fd by DMAMEM_ALLOC, that
+ * splice() and DMAMEM_SEND read from. The splice offset is relative to
+ * the block start. Spliced pages are handed to the pipe without being
+ * copied. Pages spliced from that pipe to a socket stay busy until the
+ * stack frees them, which DMAMEM_SPLICE_WAIT notices with some delay:
+ * prefer DMAMEM_SEND for sockets.
+ *
+ * @see dmamem_alloc
+ */
+#define DMAMEM_SPLICE_SELECT _IOW(DMAMEM_MAGIC, 2, struct dmamem_alloc)
+/** DMAMEM_SPLICE_WAIT
+ * wait until no pipe buffer, datagram sent by DMAMEM_SEND or other
+ * page reference, such as an skb built by splice, refers to the block
+ * anymore, so that the producer can reuse it. poll() reports POLLOUT
+ * when the selected block is in that state.
+ *
+ * @see dmamem_alloc
+ */
+#define DMAMEM_SPLICE_WAIT _IOW(DMAMEM_MAGIC, 3, struct dmamem_alloc)
+/** DMAMEM_SEND
+ * send part of the selected block as one UDP datagram, without copying
+ * it. The datagram must fit in a single IP packet, and the route device
+ * must support scatter-gather (-EOPNOTSUPP otherwise). The block is busy
+ * until the network stack and the device are done with the datagram.
+ *
+ * @see dmamem_send
+ */
+#define DMAMEM_SEND _IOW(DMAMEM_MAGIC, 4, struct dmamem_send)
 
 #endif
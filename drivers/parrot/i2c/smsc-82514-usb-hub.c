@@ -22,6 +22,7 @@
 #include <linux/debugfs.h>
 #include <linux/seq_file.h>
 #include <linux/delay.h>
+#include <linux/ktime.h>
 #include <linux/gpio.h>
 #include <mach/gpio.h>
 
@@ -86,44 +87,76 @@ struct smsc82514_data {
 	struct smsc82514_pdata ds_data;
 };
 
-/* rom default */
-static u8 smsc82514_init_seq[][2] = {
-	{SMSC82514_VENDOR_ID_LSB,		0x24},
-	{SMSC82514_VENDOR_ID_MSB,		0x04},
-	{SMSC82514_PRODUCT_ID_LSB,		0x14},/* depends of chip ... */
-	{SMSC82514_PRODUCT_ID_MSB,		0x25},
-	{SMSC82514_DEVICE_ID_LSB,		0xA0},
-	{SMSC82514_DEVICE_ID_MSB,		0x80},
-	{SMSC82514_CFG_DATA_BYTE1,		0x9B},
-	{SMSC82514_CFG_DATA_BYTE2,		0x20},
-	{SMSC82514_CFG_DATA_BYTE3,		0x02},
-	{SMSC82514_N_REMOV_DEV,			0x00},
-	{SMSC82514_PORT_DIS_SELF_PWDED,		0x00},
-	{SMSC82514_PORT_DIS_BUS_PWDED,		0x00},
-	{SMSC82514_MAX_PWR_SELF_PWDED,		0x01},
-	{SMSC82514_MAX_PWR_BUS_PWDED,		0x32},
-	{SMSC82514_HUB_CTRL_MAX_CUR_SELF_PWDED,	0x01},
-	{SMSC82514_HUB_CTRL_MAX_CUR_BUS_PWDED,	0x32},
-	{SMSC82514_POWER_ON_TIME,		0x32},
-
+/* rom default, registers 0x00 to 0x10 */
+static const u8 smsc82514_init_seq[] = {
+	[SMSC82514_VENDOR_ID_LSB]		= 0x24,
+	[SMSC82514_VENDOR_ID_MSB]		= 0x04,
+	[SMSC82514_PRODUCT_ID_LSB]		= 0x14,/* depends of chip ... */
+	[SMSC82514_PRODUCT_ID_MSB]		= 0x25,
+	[SMSC82514_DEVICE_ID_LSB]		= 0xA0,
+	[SMSC82514_DEVICE_ID_MSB]		= 0x80,
+	[SMSC82514_CFG_DATA_BYTE1]		= 0x9B,
+	[SMSC82514_CFG_DATA_BYTE2]		= 0x20,
+	[SMSC82514_CFG_DATA_BYTE3]		= 0x02,
+	[SMSC82514_N_REMOV_DEV]			= 0x00,
+	[SMSC82514_PORT_DIS_SELF_PWDED]		= 0x00,
+	[SMSC82514_PORT_DIS_BUS_PWDED]		= 0x00,
+	[SMSC82514_MAX_PWR_SELF_PWDED]		= 0x01,
+	[SMSC82514_MAX_PWR_BUS_PWDED]		= 0x32,
+	[SMSC82514_HUB_CTRL_MAX_CUR_SELF_PWDED]	= 0x01,
+	[SMSC82514_HUB_CTRL_MAX_CUR_BUS_PWDED]	= 0x32,
+	[SMSC82514_POWER_ON_TIME]		= 0x32,
 };
 
 #define SMSC82514_INIT_SEQ_SIZE  ARRAY_SIZE(smsc82514_init_seq)
 
+/* reset pulse and time for the hub to accept configuration (us) */
+#define SMSC82514_RESET_US	20000
+#define SMSC82514_CFG_READY_US	10000
+
+/*
+ * The hub auto-increments its register pointer during an SMBus block
+ * write: send consecutive registers in as few transfers as possible.
+ */
+static int smsc82514_write_regs(struct i2c_client *client, u8 reg,
+				const u8 *values, int count)
+{
+	int len;
+	int ret;
+
+	while (count > 0) {
+		len = min(count, I2C_SMBUS_BLOCK_MAX);
+
+		ret = i2c_smbus_write_block_data(client, reg, len, values);
+		if (ret < 0) {
+			dev_err(&client->dev, "%s: i2c transfer failed\n\
+					Unable to write (0x%x) register\n",
+					 __func__, reg);
+			return -EIO;
+		}
+
+		reg += len;
+		values += len;
+		count -= len;
+	}
+
+	return 0;
+}
+
 static int smsc82514_init_client(struct i2c_client *client)
 {
 	struct smsc82514_data *data = i2c_get_clientdata(client);
+	ktime_t start = ktime_get();
 	u8 value;
 	int ret;
-	int i;
 
 	//reset hub
 	if( data->ds_data.reset_pin ){
 		gpio_set_value(data->ds_data.reset_pin, 0);
 
 		/* check if hub reply to i2c */
-		ret = i2c_smbus_write_block_data(client, smsc82514_init_seq[0][0],
-				1, &smsc82514_init_seq[0][1]);
+		ret = i2c_smbus_write_block_data(client, SMSC82514_VENDOR_ID_LSB,
+				1, &smsc82514_init_seq[SMSC82514_VENDOR_ID_LSB]);
 
 		if (ret == 0) {
 			dev_err(&client->dev, " Reset failed: "
@@ -131,7 +164,7 @@ static int smsc82514_init_client(struct i2c_client *client)
 			return -EIO;
 		}
 
-		mdelay(20);
+		usleep_range(SMSC82514_RESET_US, SMSC82514_RESET_US * 2);
 
 		gpio_set_value(data->ds_data.reset_pin, 1);
 	}
@@ -148,21 +181,13 @@ static int smsc82514_init_client(struct i2c_client *client)
 		}
 	}
 
-	mdelay(10);
+	usleep_range(SMSC82514_CFG_READY_US, SMSC82514_CFG_READY_US * 2);
 
 	/* set rom default value (otherwise everything is 0 ...) */
-	for( i = 0 ; i < SMSC82514_INIT_SEQ_SIZE ; i++ ){
-
-		ret = i2c_smbus_write_block_data(client, smsc82514_init_seq[i][0],
-				1, &smsc82514_init_seq[i][1]);
-
-		if (ret < 0) {
-			dev_err(&client->dev, "%s: i2c transfer failed\n\
-					Unable to write (0x%x) register\n",
-					 __func__, smsc82514_init_seq[i][0] );
-			return -EIO;
-		}
-	}
+	ret = smsc82514_write_regs(client, 0, smsc82514_init_seq,
+				   SMSC82514_INIT_SEQ_SIZE);
+	if (ret < 0)
+		return ret;
 
 	// Apply USB husb boost
 	// Boost upstream usb hub port if necessary
@@ -213,6 +238,9 @@ static int smsc82514_init_client(struct i2c_client *client)
 		return -EIO;
 	}
 
+	dev_info(&client->dev, "hub started in %lld us\n",
+		 ktime_to_us(ktime_sub(ktime_get(), start)));
+
 	return 0;
 }
 
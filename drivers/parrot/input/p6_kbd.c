@@ -28,6 +28,8 @@
 #include <linux/interrupt.h>
 #include <linux/module.h>
 #include <linux/time.h>
+#include <linux/timer.h>
+#include <linux/spinlock.h>
 
 #include <mach/gpio.h>
 #include <mach/gpio_parrot.h>
@@ -37,12 +39,26 @@
 #define DRIVER_VERSION 0x001
 
 #define MAX_GPIO_INT 20
+#define MAX_PENDING_EVENTS 16
+
+static unsigned int coalesce_ms;
+module_param(coalesce_ms, uint, S_IRUGO | S_IWUSR);
+MODULE_PARM_DESC(coalesce_ms, "window (ms) in which key events are grouped in one frame, 0 reports each edge");
+
+struct p6_kbd_event {
+    int keycode;
+    int value;
+};
 
 struct p6_kbd_input {
     struct input_dev                *input;                         //!< input layer private data
     struct p6_platform_kbd_input    kbd_input[MAX_GPIO_INT];
     int                             counter[MAX_GPIO_INT];          //!< a counter
     suseconds_t                     press_time[MAX_GPIO_INT];       //!< a time for checking with max_pressed_time
+    spinlock_t                      lock;                           //!< protects pending events
+    struct timer_list               timer;                          //!< end of coalescing window
+    struct p6_kbd_event             pending[MAX_PENDING_EVENTS];    //!< events waiting for the window end
+    int                             npending;
 };
 
 //!< gpio state
@@ -59,6 +75,57 @@ static void reset_button_counter(struct p6_kbd_input *p6_kbd_input)
         p6_kbd_input->counter[i] = 0;
 }
 
+/* send pending events in a single frame, called with lock held */
+static void p6_kbd_flush(struct p6_kbd_input *p6_kbd_input)
+{
+    int i;
+
+    if (p6_kbd_input->npending == 0)
+        return;
+
+    for (i = 0; i < p6_kbd_input->npending; i++)
+        input_report_key(p6_kbd_input->input, p6_kbd_input->pending[i].keycode,
+                         p6_kbd_input->pending[i].value);
+    input_sync(p6_kbd_input->input);
+    p6_kbd_input->npending = 0;
+}
+
+static void p6_kbd_timer(unsigned long data)
+{
+    struct p6_kbd_input *p6_kbd_input = (struct p6_kbd_input *)data;
+    unsigned long flags;
+
+    spin_lock_irqsave(&p6_kbd_input->lock, flags);
+    p6_kbd_flush(p6_kbd_input);
+    spin_unlock_irqrestore(&p6_kbd_input->lock, flags);
+}
+
+/* report a key event, or queue it until the end of the coalescing window
+ * so that bounces and fast presses wake up readers only once
+ */
+static void p6_kbd_report(struct p6_kbd_input *p6_kbd_input, int keycode, int value)
+{
+    unsigned long flags;
+
+    if (coalesce_ms == 0) {
+        input_report_key(p6_kbd_input->input, keycode, value);
+        input_sync(p6_kbd_input->input);
+        return;
+    }
+
+    spin_lock_irqsave(&p6_kbd_input->lock, flags);
+    if (p6_kbd_input->npending == MAX_PENDING_EVENTS)
+        p6_kbd_flush(p6_kbd_input);
+
+    p6_kbd_input->pending[p6_kbd_input->npending].keycode = keycode;
+    p6_kbd_input->pending[p6_kbd_input->npending].value = value;
+    p6_kbd_input->npending++;
+
+    if (!timer_pending(&p6_kbd_input->timer))
+        mod_timer(&p6_kbd_input->timer, jiffies + msecs_to_jiffies(coalesce_ms));
+    spin_unlock_irqrestore(&p6_kbd_input->lock, flags);
+}
+
 /* button isr */
 static irqreturn_t p6_kbd_input_irq(int irq, void *dev_id)
 {
@@ -79,13 +146,11 @@ static irqreturn_t p6_kbd_input_irq(int irq, void *dev_id)
             dev_dbg(&(p6_kbd_input->input->dev), "Button Down %d\n", p6_kbd_input->counter[button]);
             if (p6_kbd_input->counter[button] >= kbd->delay) {
             //Key Pressed Event
-                input_report_key(p6_kbd_input->input, kbd->keycode, 1);
-                input_sync(p6_kbd_input->input);
+                p6_kbd_report(p6_kbd_input, kbd->keycode, 1);
 
                 if (kbd->no_long_press) {
                 //Key Released Event
-                    input_report_key(p6_kbd_input->input, kbd->keycode, 0);
-                    input_sync(p6_kbd_input->input);
+                    p6_kbd_report(p6_kbd_input, kbd->keycode, 0);
                     reset_button_counter(p6_kbd_input);
                 }
             }
@@ -96,8 +161,7 @@ static irqreturn_t p6_kbd_input_irq(int irq, void *dev_id)
             if (p6_kbd_input->counter[button] >= kbd->delay) {
                 if (!kbd->no_long_press) {
                 //Key Released Event
-                    input_report_key(p6_kbd_input->input, kbd->keycode, 0);
-                    input_sync(p6_kbd_input->input);
+                    p6_kbd_report(p6_kbd_input, kbd->keycode, 0);
                     reset_button_counter(p6_kbd_input);
                 }
                 else {
@@ -125,12 +189,10 @@ static irqreturn_t p6_kbd_input_irq(int irq, void *dev_id)
             dev_dbg(&(p6_kbd_input->input->dev), "Button Up %ld \n", current_time);
             if (current_time - p6_kbd_input->press_time[button] < kbd->max_pressed_time) {
             //Key Pressed Event
-                input_report_key(p6_kbd_input->input, kbd->keycode, 1);
-                input_sync(p6_kbd_input->input);
+                p6_kbd_report(p6_kbd_input, kbd->keycode, 1);
 
             //Key Released Event
-                input_report_key(p6_kbd_input->input, kbd->keycode, 0);
-                input_sync(p6_kbd_input->input);
+                p6_kbd_report(p6_kbd_input, kbd->keycode, 0);
 
                 reset_button_counter(p6_kbd_input);
             }
@@ -175,6 +237,8 @@ static void clean_irq_and_input(struct p6_kbd_input *p6_kbd_input)
         }
     }
 
+    del_timer_sync(&p6_kbd_input->timer);
+
     input_unregister_device(p6_kbd_input->input);
     input_free_device(p6_kbd_input->input);
 }
@@ -215,6 +279,9 @@ static int p6_input_probe(struct platform_device *pdev)
     input_dev->evbit[0] = BIT(EV_KEY);
     input_dev->evbit[0] |= BIT(EV_REP);
 
+    spin_lock_init(&p6_kbd_input->lock);
+    setup_timer(&p6_kbd_input->timer, p6_kbd_timer, (unsigned long)p6_kbd_input);
+
     gpio_set_debounce_value(22); // 26.9ms debounce dead time
 
     while (p6_kbd_input_info->keycode) {
@@ -29,14 +29,20 @@
 #include <linux/platform_device.h>
 #include <linux/clk.h>
 #include <linux/err.h>
-#include <linux/input.h>
+#include <linux/fs.h>
+#include <linux/miscdevice.h>
+#include <linux/poll.h>
+#include <linux/kfifo.h>
+#include <linux/hrtimer.h>
+#include <linux/mutex.h>
+#include <linux/sched.h>
 
 #include <asm/io.h>
 #include <mach/parrot.h>
 
 #define PARROT5_I2CS_NAME "parrot5-i2cs"
 #define DRIVER_NAME PARROT5_I2CS_NAME
-#define DRIVER_VERSION 0x001
+#define DRIVER_VERSION 0x002
 
 #define I2CS_ADDRESS 0
 #define I2CS_ITEN 4
@@ -46,15 +52,44 @@
 #define I2CS_ITACK 1
 #define I2CS_TRANSMIT 0xc
 #define I2CS_RECEIVE 0x20
+#define I2CS_RECEIVE_EMPTY 0x100
+
+#define I2CS_RX_FIFO_SIZE 4096		/* received messages, with their length */
+#define I2CS_TX_FIFO_SIZE 1024		/* bytes to send on master reads */
+#define I2CS_MAX_MSG 256		/* longer writes are split */
+#define I2CS_TX_IDLE 0xff		/* sent when there is nothing to send */
+
+static unsigned int slave_addr = 0x45;
+module_param(slave_addr, uint, S_IRUGO);
+MODULE_PARM_DESC(slave_addr, "I2C slave address");
+
+static unsigned int msg_gap_us = 200;
+module_param(msg_gap_us, uint, S_IRUGO | S_IWUSR);
+MODULE_PARM_DESC(msg_gap_us, "bus idle time (us) ending a received message");
 
 struct parrot5_i2cs_data {
-	struct input_dev				*input;
 	struct parrot5_i2cs_platform	*pdata;
 
 	struct clk					*clk;
 
 	struct resource				*ioarea;
 	void __iomem				*base;
+	int						irq;
+
+	struct miscdevice			misc;
+	spinlock_t					lock;		/* rx producers */
+	struct mutex				rx_mutex;	/* readers */
+	struct mutex				tx_mutex;	/* writers */
+	wait_queue_head_t			rx_wait;
+	wait_queue_head_t			tx_wait;
+	STRUCT_KFIFO_REC_2(I2CS_RX_FIFO_SIZE)	rx_fifo;
+	DECLARE_KFIFO(tx_fifo, unsigned char, I2CS_TX_FIFO_SIZE);
+
+	/* message being received */
+	unsigned char				msg[I2CS_MAX_MSG];
+	unsigned int				msg_len;
+	struct hrtimer				msg_timer;
+	unsigned long				rx_dropped;
 };
 
 
@@ -72,35 +107,175 @@ static void parrot5_i2cs_disable_irq(struct parrot5_i2cs_data *drv_data)
 	writel(I2CS_ITEN_ITDIS, drv_data->base + I2CS_ITEN);
 }
 
+/*
+ * Queue the message being received for readers. Called with lock held.
+ *
+ * The slave block does not report STOP conditions: a message ends when
+ * the master starts a read, when the bus has been idle for msg_gap_us,
+ * or when it reaches I2CS_MAX_MSG bytes.
+ */
+static void parrot5_i2cs_end_msg(struct parrot5_i2cs_data *drv_data)
+{
+	if (drv_data->msg_len == 0)
+		return;
+
+	if (kfifo_avail(&drv_data->rx_fifo) >= drv_data->msg_len) {
+		kfifo_in(&drv_data->rx_fifo, drv_data->msg, drv_data->msg_len);
+		wake_up_interruptible(&drv_data->rx_wait);
+	} else if (drv_data->rx_dropped++ == 0) {
+		printk(KERN_WARNING DRIVER_NAME
+		       ": rx buffer full, dropping messages\n");
+	}
+
+	drv_data->msg_len = 0;
+}
+
+static enum hrtimer_restart parrot5_i2cs_msg_timeout(struct hrtimer *timer)
+{
+	struct parrot5_i2cs_data *drv_data =
+		container_of(timer, struct parrot5_i2cs_data, msg_timer);
+	unsigned long flags;
+
+	spin_lock_irqsave(&drv_data->lock, flags);
+	parrot5_i2cs_end_msg(drv_data);
+	spin_unlock_irqrestore(&drv_data->lock, flags);
+
+	return HRTIMER_NORESTART;
+}
+
 static irqreturn_t parrot5_i2cs_irq(int irq, void *dev_id)
 {
 	struct parrot5_i2cs_data *drv_data = dev_id;
+	unsigned char c;
 
 	unsigned int data = readl(drv_data->base + I2CS_RECEIVE);
 
-	if ((data & 0x100) == 0) {
-		while ((data & 0x100) == 0) {
-			data &= 0xff;
-			printk("receive %x\n", data);
+	spin_lock(&drv_data->lock);
+	if ((data & I2CS_RECEIVE_EMPTY) == 0) {
+		while ((data & I2CS_RECEIVE_EMPTY) == 0) {
+			drv_data->msg[drv_data->msg_len++] = data & 0xff;
+			if (drv_data->msg_len == I2CS_MAX_MSG)
+				parrot5_i2cs_end_msg(drv_data);
 			data = readl(drv_data->base + I2CS_RECEIVE);
-			/* XXX hack to set supported key */
-			set_bit(data & 0x7f, drv_data->input->keybit);
-			/* send key to input layer */
-			input_report_key(drv_data->input, data & 0x7f, data & 0x80);
-			input_sync(drv_data->input);
 		}
+		hrtimer_start(&drv_data->msg_timer,
+			      ns_to_ktime((u64)msg_gap_us * NSEC_PER_USEC),
+			      HRTIMER_MODE_REL);
 	}
 	else {
-		printk("tx interrupt\n");
-		/* XXX always read 0xde */
-		writel(0xde, drv_data->base + I2CS_TRANSMIT);
+		/* master read: previous write is over */
+		hrtimer_try_to_cancel(&drv_data->msg_timer);
+		parrot5_i2cs_end_msg(drv_data);
+
+		if (!kfifo_get(&drv_data->tx_fifo, &c))
+			c = I2CS_TX_IDLE;
+		writel(c, drv_data->base + I2CS_TRANSMIT);
 		writel(I2CS_ITACK, drv_data->base + I2CS_ITACK_ITACK);
+		wake_up_interruptible(&drv_data->tx_wait);
 	}
+	spin_unlock(&drv_data->lock);
 
 	return IRQ_HANDLED;
 }
 
 
+/**
+ * Character device: one read() returns one message, write() queues bytes
+ * for the master to read.
+ */
+static int parrot5_i2cs_open(struct inode *inode, struct file *file)
+{
+	return nonseekable_open(inode, file);
+}
+
+static struct parrot5_i2cs_data *file_to_i2cs(struct file *file)
+{
+	struct miscdevice *misc = file->private_data;
+
+	return container_of(misc, struct parrot5_i2cs_data, misc);
+}
+
+static ssize_t parrot5_i2cs_read(struct file *file, char __user *buf,
+				 size_t count, loff_t *ppos)
+{
+	struct parrot5_i2cs_data *drv_data = file_to_i2cs(file);
+	unsigned int copied;
+	int ret;
+
+	if (mutex_lock_interruptible(&drv_data->rx_mutex))
+		return -ERESTARTSYS;
+
+	while (kfifo_is_empty(&drv_data->rx_fifo)) {
+		mutex_unlock(&drv_data->rx_mutex);
+		if (file->f_flags & O_NONBLOCK)
+			return -EAGAIN;
+		if (wait_event_interruptible(drv_data->rx_wait,
+				!kfifo_is_empty(&drv_data->rx_fifo)))
+			return -ERESTARTSYS;
+		if (mutex_lock_interruptible(&drv_data->rx_mutex))
+			return -ERESTARTSYS;
+	}
+
+	/* a message longer than count is truncated */
+	ret = kfifo_to_user(&drv_data->rx_fifo, buf, count, &copied);
+	mutex_unlock(&drv_data->rx_mutex);
+
+	return ret ? ret : copied;
+}
+
+static ssize_t parrot5_i2cs_write(struct file *file, const char __user *buf,
+				  size_t count, loff_t *ppos)
+{
+	struct parrot5_i2cs_data *drv_data = file_to_i2cs(file);
+	unsigned int copied;
+	int ret;
+
+	if (mutex_lock_interruptible(&drv_data->tx_mutex))
+		return -ERESTARTSYS;
+
+	while (kfifo_is_full(&drv_data->tx_fifo)) {
+		mutex_unlock(&drv_data->tx_mutex);
+		if (file->f_flags & O_NONBLOCK)
+			return -EAGAIN;
+		if (wait_event_interruptible(drv_data->tx_wait,
+				!kfifo_is_full(&drv_data->tx_fifo)))
+			return -ERESTARTSYS;
+		if (mutex_lock_interruptible(&drv_data->tx_mutex))
+			return -ERESTARTSYS;
+	}
+
+	ret = kfifo_from_user(&drv_data->tx_fifo, buf, count, &copied);
+	mutex_unlock(&drv_data->tx_mutex);
+
+	return ret ? ret : copied;
+}
+
+static unsigned int parrot5_i2cs_poll(struct file *file, poll_table *wait)
+{
+	struct parrot5_i2cs_data *drv_data = file_to_i2cs(file);
+	unsigned int mask = 0;
+
+	poll_wait(file, &drv_data->rx_wait, wait);
+	poll_wait(file, &drv_data->tx_wait, wait);
+
+	if (!kfifo_is_empty(&drv_data->rx_fifo))
+		mask |= POLLIN | POLLRDNORM;
+	if (!kfifo_is_full(&drv_data->tx_fifo))
+		mask |= POLLOUT | POLLWRNORM;
+
+	return mask;
+}
+
+static const struct file_operations parrot5_i2cs_fops = {
+	.owner		= THIS_MODULE,
+	.open		= parrot5_i2cs_open,
+	.read		= parrot5_i2cs_read,
+	.write		= parrot5_i2cs_write,
+	.poll		= parrot5_i2cs_poll,
+	.llseek		= no_llseek,
+};
+
+
 /**
  * Hardware init
  */
@@ -117,8 +292,7 @@ static int parrot5_i2cs_hw_init(struct parrot5_i2cs_data *drv_data)
 	}
 	clk_enable(drv_data->clk);
 
-	/* XXX hardcoded address pass it, via platform data */
-	writel(0x45, drv_data->base + I2CS_ADDRESS);
+	writel(slave_addr, drv_data->base + I2CS_ADDRESS);
 
 	/* interrupt mode  */
 	parrot5_i2cs_enable_irq(drv_data);
@@ -133,7 +307,6 @@ exit:
 static int parrot5_i2cs_probe(struct platform_device *pdev)
 {
 	struct parrot5_i2cs_data *drv_data;
-	struct input_dev *input_dev;
 	struct resource *res;
 	int ret;
 
@@ -144,11 +317,6 @@ static int parrot5_i2cs_probe(struct platform_device *pdev)
 	}
 
 	drv_data->pdata = pdev->dev.platform_data;
-	if (!drv_data->pdata) {
-		dev_err(&pdev->dev, "no driver data\n");
-		ret = -ENODEV;
-		goto no_pdata;
-	}
 
 	res = platform_get_resource(pdev, IORESOURCE_MEM, 0);
 	if (!res) {
@@ -173,31 +341,18 @@ static int parrot5_i2cs_probe(struct platform_device *pdev)
 		goto no_map;
 	}
 
-	/* input init */
-	input_dev = input_allocate_device();
-
-	if (!input_dev) {
-		ret = -ENOMEM;
-		goto input_failure;
-	}
-	drv_data->input = input_dev;
-	input_dev->name = DRIVER_NAME;
-	input_dev->phys = DRIVER_NAME"/input0";
-
-	input_dev->id.bustype = BUS_HOST;
-	input_dev->id.vendor = 0x0001;
-	input_dev->id.product = 0x0001;
-	input_dev->id.version = DRIVER_VERSION;
-	input_dev->evbit[0] = BIT(EV_KEY);
-	input_dev->evbit[0] |= BIT(EV_REP);
-	while (0) {
-		set_bit(/*keycode*/0, input_dev->keybit);
-	}
-	ret = input_register_device(drv_data->input);
-	if (ret)
-		goto input_register_failure;
-
-	ret = request_irq(platform_get_irq(pdev, 0),
+	spin_lock_init(&drv_data->lock);
+	mutex_init(&drv_data->rx_mutex);
+	mutex_init(&drv_data->tx_mutex);
+	init_waitqueue_head(&drv_data->rx_wait);
+	init_waitqueue_head(&drv_data->tx_wait);
+	INIT_KFIFO(drv_data->rx_fifo);
+	INIT_KFIFO(drv_data->tx_fifo);
+	hrtimer_init(&drv_data->msg_timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+	drv_data->msg_timer.function = parrot5_i2cs_msg_timeout;
+
+	drv_data->irq = platform_get_irq(pdev, 0);
+	ret = request_irq(drv_data->irq,
 			  parrot5_i2cs_irq, IRQF_SHARED,
 			  pdev->name, drv_data);
 	if (ret) {
@@ -211,26 +366,37 @@ static int parrot5_i2cs_probe(struct platform_device *pdev)
 		goto err_hw;
 	}
 
+	drv_data->misc.minor = MISC_DYNAMIC_MINOR;
+	drv_data->misc.name = "i2cs";
+	drv_data->misc.fops = &parrot5_i2cs_fops;
+	drv_data->misc.parent = &pdev->dev;
+	ret = misc_register(&drv_data->misc);
+	if (ret) {
+		dev_err(&pdev->dev, "misc device registration failed (%d)\n", ret);
+		goto err_misc;
+	}
+
 	platform_set_drvdata(pdev, drv_data);
 
-	dev_info(&pdev->dev, "controller probe successfully\n");
+	dev_info(&pdev->dev, "controller probe successfully, address 0x%02x\n",
+		 slave_addr);
 
 	return 0;
 
+err_misc:
+	parrot5_i2cs_disable_irq(drv_data);
+	clk_disable(drv_data->clk);
+	clk_put(drv_data->clk);
 err_hw:
-	free_irq(platform_get_irq(pdev, 0), drv_data);
+	free_irq(drv_data->irq, drv_data);
+	hrtimer_cancel(&drv_data->msg_timer);
 no_irq:
-	input_unregister_device(drv_data->input);
-input_register_failure:
-	input_free_device(drv_data->input);
-input_failure:
-no_map:
 	iounmap(drv_data->base);
+no_map:
 	release_resource(drv_data->ioarea);
 no_res:
 	kfree(drv_data);
 
-no_pdata:
 no_mem:
 	return ret;
 
@@ -244,13 +410,13 @@ static int parrot5_i2cs_remove(struct platform_device *pdev)
 {
 	struct parrot5_i2cs_data *drv_data = platform_get_drvdata(pdev);
 
-	input_unregister_device(drv_data->input);
-	input_free_device(drv_data->input);
+	misc_deregister(&drv_data->misc);
 
 	parrot5_i2cs_disable_irq(drv_data);
 	clk_disable(drv_data->clk);
 	clk_put(drv_data->clk);
-	free_irq(platform_get_irq(pdev, 0), drv_data);
+	free_irq(drv_data->irq, drv_data);
+	hrtimer_cancel(&drv_data->msg_timer);
 
 	iounmap(drv_data->base);
 
@@ -28,6 +28,8 @@
 #include <linux/interrupt.h>
 #include <linux/module.h>
 #include <linux/time.h>
+#include <linux/timer.h>
+#include <linux/spinlock.h>
 
 #include <mach/gpio.h>
 #include <mach/gpio_parrot.h>
@@ -37,12 +39,64 @@
 
 #define NB_ROT_INT 2
 
+static unsigned int coalesce_ms;
+module_param(coalesce_ms, uint, S_IRUGO | S_IWUSR);
+MODULE_PARM_DESC(coalesce_ms, "window (ms) in which rotation steps are summed in one frame, 0 reports each step");
+
 struct rnb4_rot_input {
     struct input_dev	*input;		//!< input layer private data
     int irq[NB_ROT_INT];
     int gpio[NB_ROT_INT];
+    spinlock_t lock;			//!< protects delta
+    struct timer_list timer;		//!< end of coalescing window
+    int delta;				//!< net steps since window start, > 0 is KEY_UP
 };
 
+/* send one KEY_UP or KEY_DOWN click per step of the net rotation, in a
+ * single frame. Called with lock held.
+ */
+static void rnb4_rot_flush(struct rnb4_rot_input *rnb4_rot_input)
+{
+    int keycode = rnb4_rot_input->delta > 0 ? KEY_UP : KEY_DOWN;
+    int steps = abs(rnb4_rot_input->delta);
+
+    if (steps == 0)
+    	return;
+
+    while (steps--)
+    {
+    	input_report_key(rnb4_rot_input->input, keycode, 1);
+    	input_report_key(rnb4_rot_input->input, keycode, 0);
+    }
+    input_sync(rnb4_rot_input->input);
+    rnb4_rot_input->delta = 0;
+}
+
+static void rnb4_rot_timer(unsigned long data)
+{
+    struct rnb4_rot_input *rnb4_rot_input = (struct rnb4_rot_input *)data;
+    unsigned long flags;
+
+    spin_lock_irqsave(&rnb4_rot_input->lock, flags);
+    rnb4_rot_flush(rnb4_rot_input);
+    spin_unlock_irqrestore(&rnb4_rot_input->lock, flags);
+}
+
+/* account one rotation step, reported at the end of the coalescing window */
+static void rnb4_rot_step(struct rnb4_rot_input *rnb4_rot_input, int keycode)
+{
+    unsigned long flags;
+
+    spin_lock_irqsave(&rnb4_rot_input->lock, flags);
+    rnb4_rot_input->delta += (keycode == KEY_UP) ? 1 : -1;
+
+    if (coalesce_ms == 0)
+    	rnb4_rot_flush(rnb4_rot_input);
+    else if (!timer_pending(&rnb4_rot_input->timer))
+    	mod_timer(&rnb4_rot_input->timer, jiffies + msecs_to_jiffies(coalesce_ms));
+    spin_unlock_irqrestore(&rnb4_rot_input->lock, flags);
+}
+
 /* button isr */
 static irqreturn_t rnb4_rot_input_irq(int irq, void *dev_id)
 {
@@ -54,15 +108,11 @@ static irqreturn_t rnb4_rot_input_irq(int irq, void *dev_id)
     {
     	if(rotator_get_status(0) == ROTATOR_EVENT_LEFT)
     	{
-			input_report_key(rnb4_rot_input->input, KEY_DOWN, 1);
-			input_report_key(rnb4_rot_input->input, KEY_DOWN, 0);
-			input_sync(rnb4_rot_input->input);
+			rnb4_rot_step(rnb4_rot_input, KEY_DOWN);
     	}
     	else
     	{
-			input_report_key(rnb4_rot_input->input, KEY_UP, 1);
-			input_report_key(rnb4_rot_input->input, KEY_UP, 0);
-			input_sync(rnb4_rot_input->input);
+			rnb4_rot_step(rnb4_rot_input, KEY_UP);
     	}
     }
 
@@ -120,15 +170,11 @@ static irqreturn_t rnb4_rot_input_irq(int irq, void *dev_id)
     	{
         	if(last > button)
         	{
-    			input_report_key(rnb4_rot_input->input, KEY_UP, 1);
-    			input_report_key(rnb4_rot_input->input, KEY_UP, 0);
-    			input_sync(rnb4_rot_input->input);
+    			rnb4_rot_step(rnb4_rot_input, KEY_UP);
         	}
         	else
         	{
-    			input_report_key(rnb4_rot_input->input, KEY_DOWN, 1);
-    			input_report_key(rnb4_rot_input->input, KEY_DOWN, 0);
-    			input_sync(rnb4_rot_input->input);
+    			rnb4_rot_step(rnb4_rot_input, KEY_DOWN);
         	}
         	last = 0xFF;
         	direction = 0xFF;
@@ -192,6 +238,7 @@ static void clean_irq_and_input(struct rnb4_rot_input *rnb4_rot_input)
     gpio_interrupt_unregister(rnb4_rot_input->gpio[0]);
     free_irq(rnb4_rot_input->irq[1], rnb4_rot_input);
     gpio_interrupt_unregister(rnb4_rot_input->gpio[1]);
+    del_timer_sync(&rnb4_rot_input->timer);
 
     input_unregister_device(rnb4_rot_input->input);
     input_free_device(rnb4_rot_input->input);
@@ -231,6 +278,9 @@ static int rnb4_rotator_probe(struct platform_device *pdev)
     input_dev->id.version = DRIVER_VERSION;
     input_dev->evbit[0] = BIT(EV_KEY);
 
+    spin_lock_init(&rnb4_rot_input->lock);
+    setup_timer(&rnb4_rot_input->timer, rnb4_rot_timer, (unsigned long)rnb4_rot_input);
+
     add_button(118, KEY_UP, rnb4_rot_input);
     add_button(119, KEY_DOWN, rnb4_rot_input);
 
@@ -40,6 +40,10 @@
 #include <media/v4l2-ioctl.h>
 
 #include <mach/regs-camif-p6.h>
+
+#define CREATE_TRACE_POINTS
+#include "p6_camif_trace.h"
+
 struct p6_camif_info {
 	unsigned long flags; /* SOCAM_... */
 	void (*enable_camera)(void);
@@ -415,16 +419,20 @@ static irqreturn_t p6_camif_irq(int irq, void *data)
 		vb->state = VIDEOBUF_DONE;
 		do_gettimeofday(&vb->ts);
 		vb->field_count++;
+		trace_camif_frame_done(vb);
 		wake_up(&vb->done);
 	}
 	/* XXX strange things can happen with blockline, if silent drop is enabled */
 	else if (!silent_drop_frame) {
 		dev_dbg(&icd->dev, "no new buffer : %d\n", pcdev->active_idx);
+		trace_camif_frame_drop(vb, 1);
 		abort_current_buffer(icd, 1);
 		goto exit;
 	}
-	else
+	else {
+		trace_camif_frame_drop(vb, 0);
 		printk("drop frame\n");
+	}
 
 	pcdev->active_idx++;
 	if (pcdev->active_idx > 2)
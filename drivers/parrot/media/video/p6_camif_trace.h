@@ -0,0 +1,73 @@
+#undef TRACE_SYSTEM
+#define TRACE_SYSTEM parrot
+
+#if !defined(_P6_CAMIF_TRACE_H) || defined(TRACE_HEADER_MULTI_READ)
+#define _P6_CAMIF_TRACE_H
+
+#include <linux/types.h>
+#include <linux/tracepoint.h>
+#include <media/videobuf-dma-contig.h>
+
+/*
+ * camif tracepoints, in the same "parrot" system as the other Parrot
+ * drivers (include/trace/events/parrot.h).
+ *
+ * They take the videobuf and look up its DMA address in TP_fast_assign, so
+ * nothing is computed at the call site while the events are disabled. That
+ * lookup lives in videobuf-dma-contig, hence the events are instantiated in
+ * p6_camif.c rather than in the built-in drivers/parrot/trace.c.
+ */
+
+TRACE_EVENT(camif_frame_done,
+
+	TP_PROTO(struct videobuf_buffer *vb),
+
+	TP_ARGS(vb),
+
+	TP_STRUCT__entry(
+		__field(	unsigned int,	idx		)
+		__field(	u32,		addr		)
+		__field(	unsigned int,	field_count	)
+	),
+
+	TP_fast_assign(
+		__entry->idx		= vb->i;
+		__entry->addr		= videobuf_to_dma_contig(vb);
+		__entry->field_count	= vb->field_count;
+	),
+
+	TP_printk("buf=%u addr=0x%08x seq=%u",
+		  __entry->idx, __entry->addr, __entry->field_count)
+);
+
+TRACE_EVENT(camif_frame_drop,
+
+	TP_PROTO(struct videobuf_buffer *vb, int aborted),
+
+	TP_ARGS(vb, aborted),
+
+	TP_STRUCT__entry(
+		__field(	unsigned int,	idx		)
+		__field(	u32,		addr		)
+		__field(	int,		aborted		)
+	),
+
+	TP_fast_assign(
+		__entry->idx		= vb->i;
+		__entry->addr		= videobuf_to_dma_contig(vb);
+		__entry->aborted	= aborted;
+	),
+
+	TP_printk("buf=%u addr=0x%08x %s",
+		  __entry->idx, __entry->addr,
+		  __entry->aborted ? "aborted" : "reused")
+);
+
+#endif /* _P6_CAMIF_TRACE_H */
+
+/* This part must be outside protection */
+#undef TRACE_INCLUDE_PATH
+#define TRACE_INCLUDE_PATH .
+#undef TRACE_INCLUDE_FILE
+#define TRACE_INCLUDE_FILE p6_camif_trace
+#include <trace/define_trace.h>
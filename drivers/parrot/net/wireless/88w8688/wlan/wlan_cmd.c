@@ -2483,9 +2483,14 @@ wlan_exec_next_cmd(wlan_private * priv)
         if (Adapter->MediaConnectStatus == WlanMediaStateConnected) {
             /* 
              * check if in power save mode, if yes, put the device back
-             * to PS mode
+             * to PS mode, unless traffic keeps it at full power
              */
-            if ((Adapter->PSMode != Wlan802_11PowerModeCAM) &&
+            if (Adapter->PSAutoAwake) {
+                if (Adapter->PSState == PS_STATE_AWAKE) {
+                    PRINTM(INFO, "EXEC_NEXT_CMD: Traffic, leave PS\n");
+                    wlan_exit_ps(priv, 0);
+                }
+            } else if ((Adapter->PSMode != Wlan802_11PowerModeCAM) &&
                 (Adapter->PSState == PS_STATE_FULL_POWER)) {
                 if (Adapter->SecInfo.WPAEnabled || Adapter->SecInfo.WPA2Enabled) {
                     if (Adapter->IsGTK_SET) {
@@ -2689,6 +2694,62 @@ wlan_exit_ps(wlan_private * priv, int wait_option)
     return;
 }
 
+/** 
+ *  @brief This function samples the TX/RX activity for the traffic-aware
+ *  power save. Power save is left as soon as a sample sees
+ *  ps_auto_threshold packets, and entered again after ps_auto_idle ms
+ *  without such a sample. The PS commands are sent by the main thread
+ *  from wlan_exec_next_cmd().
+ *  
+ *  @param FunctionContext    A pointer to FunctionContext
+ *  @return 	   	n/a 
+ */
+void
+wlan_ps_auto_timer_func(void *FunctionContext)
+{
+    wlan_private *priv = (wlan_private *) FunctionContext;
+    wlan_adapter *Adapter = priv->adapter;
+    unsigned long pkts;
+
+    ENTER();
+
+    pkts = priv->stats.tx_packets + priv->stats.rx_packets;
+
+    if (ps_auto_threshold && (Adapter->PSMode != Wlan802_11PowerModeCAM)
+        && (Adapter->MediaConnectStatus == WlanMediaStateConnected)) {
+        if (pkts - Adapter->PSAutoLastPkts >= ps_auto_threshold) {
+            Adapter->PSAutoLastActive = jiffies;
+            if (!Adapter->PSAutoAwake) {
+                PRINTM(INFO, "PS_AUTO: traffic, leaving PS\n");
+                Adapter->PSAutoAwake = TRUE;
+                Adapter->dbg.num_ps_auto_exit++;
+                wake_up_interruptible(&priv->MainThread.waitQ);
+            }
+        } else if (Adapter->PSAutoAwake &&
+                   time_after(jiffies, Adapter->PSAutoLastActive +
+                              msecs_to_jiffies(ps_auto_idle))) {
+            PRINTM(INFO, "PS_AUTO: idle, back to PS\n");
+            Adapter->PSAutoAwake = FALSE;
+            Adapter->dbg.num_ps_auto_enter++;
+            wake_up_interruptible(&priv->MainThread.waitQ);
+        }
+
+        if (Adapter->PSAutoAwake)
+            Adapter->dbg.ps_auto_awake_ms += PS_AUTO_SAMPLE_PERIOD;
+        else
+            Adapter->dbg.ps_auto_ps_ms += PS_AUTO_SAMPLE_PERIOD;
+    } else {
+        /* Power save disabled or link down: nothing to restore */
+        Adapter->PSAutoAwake = FALSE;
+    }
+    Adapter->PSAutoLastPkts = pkts;
+
+    if (Adapter->PSAutoTimerIsSet)
+        wlan_mod_timer(&Adapter->PSAutoTimer, PS_AUTO_SAMPLE_PERIOD);
+
+    LEAVE();
+}
+
 /** 
  *  @brief This function checks condition and prepares to
  *  send sleep confirm command to firmware if OK.
@@ -114,6 +114,22 @@ static struct debug_data items[] = {
      item_dbg_addr(num_cmd_assoc_success)},
     {"num_cmd_assoc_fail", item_dbg_size(num_cmd_assoc_failure), 0,
      item_dbg_addr(num_cmd_assoc_failure)},
+    {"num_ps_auto_exit", item_dbg_size(num_ps_auto_exit), 0,
+     item_dbg_addr(num_ps_auto_exit)},
+    {"num_ps_auto_enter", item_dbg_size(num_ps_auto_enter), 0,
+     item_dbg_addr(num_ps_auto_enter)},
+    {"ps_auto_awake_ms", item_dbg_size(ps_auto_awake_ms), 0,
+     item_dbg_addr(ps_auto_awake_ms)},
+    {"ps_auto_ps_ms", item_dbg_size(ps_auto_ps_ms), 0,
+     item_dbg_addr(ps_auto_ps_ms)},
+    {"num_main_wakeup", item_dbg_size(num_main_wakeup), 0,
+     item_dbg_addr(num_main_wakeup)},
+    {"main_lat_last_us", item_dbg_size(main_lat_last_us), 0,
+     item_dbg_addr(main_lat_last_us)},
+    {"main_lat_avg_us", item_dbg_size(main_lat_avg_us), 0,
+     item_dbg_addr(main_lat_avg_us)},
+    {"main_lat_max_us", item_dbg_size(main_lat_max_us), 0,
+     item_dbg_addr(main_lat_max_us)},
 
     {"cmd_sent", item1_size(cmd_sent), 0, item1_addr(cmd_sent)},
     {"data_sent", item1_size(data_sent), 0, item1_addr(data_sent)},
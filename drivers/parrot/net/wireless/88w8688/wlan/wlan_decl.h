@@ -113,6 +113,14 @@ int wlan_process_rx_packet(wlan_private * priv, struct sk_buff *);
 void wlan_enter_ps(wlan_private * priv, int wait_option);
 void wlan_ps_cond_check(wlan_private * priv, u16 PSMode);
 void wlan_exit_ps(wlan_private * priv, int wait_option);
+void wlan_ps_auto_timer_func(void *FunctionContext);
+
+/** Traffic-aware power save sampling period, in milliseconds */
+#define PS_AUTO_SAMPLE_PERIOD		100
+extern unsigned int ps_auto_threshold;
+extern unsigned int ps_auto_idle;
+extern unsigned int main_thread_policy;
+extern unsigned int main_thread_priority;
 
 extern CHANNEL_FREQ_POWER *find_cfp_by_band_and_channel(wlan_adapter * adapter,
                                                         u8 band, u16 channel);
@@ -151,6 +159,11 @@ void send_iwevcustom_event(wlan_private * priv, s8 * str);
 
 /** The number of times to try when polling for status bits */
 #define MAX_POLL_TRIES			100
+/** Number of polls done with a busy wait before backing off to sleeps */
+#define POLL_SPIN_TRIES			4
+/** Initial and maximum poll back-off, in microseconds */
+#define POLL_MIN_BACKOFF_US		20
+#define POLL_MAX_BACKOFF_US		1000
 
 /** The number of times to try when waiting for downloaded firmware to 
      become active. (polling the scratch register). */
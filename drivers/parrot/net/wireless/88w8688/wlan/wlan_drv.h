@@ -208,6 +208,22 @@ typedef struct _wlan_dbg
     u16 LastEventIndex;
     /** Number of channel switch disassociation */
     u32 num_event_channel_switch;
+    /** Number of power save exits due to traffic */
+    u32 num_ps_auto_exit;
+    /** Number of power save re-entries after idle */
+    u32 num_ps_auto_enter;
+    /** Time kept at full power by traffic, in milliseconds */
+    u32 ps_auto_awake_ms;
+    /** Time with power save allowed, in milliseconds */
+    u32 ps_auto_ps_ms;
+    /** Number of main thread wakeups */
+    u32 num_main_wakeup;
+    /** Last main thread wakeup to run latency, in microseconds */
+    u32 main_lat_last_us;
+    /** Average wakeup to run latency (1/8 weight), in microseconds */
+    u32 main_lat_avg_us;
+    /** Worst wakeup to run latency, in microseconds */
+    u32 main_lat_max_us;
 } wlan_dbg;
 
 /** Data structure for the Marvell WLAN device */
@@ -481,6 +497,16 @@ struct _wlan_adapter
     u32 PSState;
     /** Need to wakeup flag */
     BOOLEAN NeedToWakeup;
+    /** Traffic-aware power save: held at full power by traffic */
+    BOOLEAN PSAutoAwake;
+    /** Traffic-aware power save: packet count at the previous sample */
+    unsigned long PSAutoLastPkts;
+    /** Traffic-aware power save: last busy sample, in jiffies */
+    unsigned long PSAutoLastActive;
+    /** Traffic-aware power save sampling timer */
+    WLAN_DRV_TIMER PSAutoTimer __ATTRIB_ALIGN__;
+    /** Traffic-aware power save timer set flag */
+    BOOLEAN PSAutoTimerIsSet;
 
     /** Power save confirm sleep command */
     PS_CMD_ConfirmSleep PSConfirmSleep;
@@ -47,6 +47,15 @@ char *fw_name = NULL;
 int mfgmode = 0;
 #endif
 
+/** Packets per sample that take the card out of power save, 0 = disabled */
+unsigned int ps_auto_threshold = 0;
+/** Idle time before power save is entered again, in milliseconds */
+unsigned int ps_auto_idle = 2000;
+/** Scheduling policy of the main service thread */
+unsigned int main_thread_policy = SCHED_NORMAL;
+/** Real-time priority of the main service thread */
+unsigned int main_thread_priority = 0;
+
 /********************************************************
 		Global Variables
 ********************************************************/
@@ -211,6 +220,7 @@ wlan_init_adapter(wlan_private * priv)
 
     Adapter->PSState = PS_STATE_FULL_POWER;
     Adapter->NeedToWakeup = FALSE;
+    Adapter->PSAutoAwake = FALSE;
     Adapter->LocalListenInterval = 0;   /* default value in firmware will be
                                            used */
     Adapter->fwWakeupMethod = WAKEUP_FW_UNCHANGED;
@@ -281,6 +291,11 @@ wlan_init_sw(wlan_private * priv)
     Adapter->ReassocTimerIsSet = FALSE;
 #endif /* REASSOCIATION */
 
+    /* Initialize the timer for the traffic-aware power save */
+    wlan_initialize_timer(&Adapter->PSAutoTimer, wlan_ps_auto_timer_func,
+                          priv);
+    Adapter->PSAutoTimerIsSet = FALSE;
+
   done:
     LEAVE();
     return ret;
@@ -428,6 +443,11 @@ wlan_init_fw(wlan_private * priv)
 
     Adapter->HardwareStatus = WlanHardwareStatusReady;
     ret = WLAN_STATUS_SUCCESS;
+
+    if (ps_auto_threshold) {
+        Adapter->PSAutoTimerIsSet = TRUE;
+        wlan_mod_timer(&Adapter->PSAutoTimer, PS_AUTO_SAMPLE_PERIOD);
+    }
   done:
     if (priv->fw_helper)
         release_firmware(priv->fw_helper);
@@ -470,6 +490,13 @@ wlan_free_adapter(wlan_private * priv)
         Adapter->CommandTimerIsSet = FALSE;
     }
     FreeTimer(&Adapter->MrvDrvCommandTimer);
+
+    PRINTM(INFO, "Free PSAutoTimer\n");
+    if (Adapter->PSAutoTimerIsSet) {
+        Adapter->PSAutoTimerIsSet = FALSE;
+        wlan_cancel_timer(&Adapter->PSAutoTimer);
+    }
+    FreeTimer(&Adapter->PSAutoTimer);
 #ifdef REASSOCIATION
     PRINTM(INFO, "Free MrvDrvTimer\n");
     if (Adapter->ReassocTimerIsSet) {
@@ -558,6 +585,30 @@ module_param(fw_name, charp, 0);
 MODULE_PARM(fw_name, "s");
 #endif
 MODULE_PARM_DESC(fw_name, "Firmware name");
+#if LINUX_VERSION_CODE > KERNEL_VERSION(2,5,0)
+module_param(ps_auto_threshold, uint, 0644);
+module_param(ps_auto_idle, uint, 0644);
+#else
+MODULE_PARM(ps_auto_threshold, "i");
+MODULE_PARM(ps_auto_idle, "i");
+#endif
+MODULE_PARM_DESC(ps_auto_threshold,
+                 "Packets per 100ms that leave power save (0: disabled, "
+                 "checked at firmware init)");
+MODULE_PARM_DESC(ps_auto_idle,
+                 "Idle time in ms before power save is entered again");
+#if LINUX_VERSION_CODE > KERNEL_VERSION(2,5,0)
+module_param(main_thread_policy, uint, 0644);
+module_param(main_thread_priority, uint, 0644);
+#else
+MODULE_PARM(main_thread_policy, "i");
+MODULE_PARM(main_thread_priority, "i");
+#endif
+MODULE_PARM_DESC(main_thread_policy,
+                 "Main thread policy (0: SCHED_NORMAL, 1: SCHED_FIFO, "
+                 "2: SCHED_RR), applied at its next wakeup");
+MODULE_PARM_DESC(main_thread_priority,
+                 "Main thread real-time priority (1-99)");
 
 #ifdef MFG_CMD_SUPPORT
 #if LINUX_VERSION_CODE > KERNEL_VERSION(2,5,0)
@@ -689,6 +689,95 @@ wlan_set_multicast_list(struct net_device *dev)
     LEAVE();
 }
 
+/** Main thread wait queue entry, stamps the wakeup time */
+typedef struct _wlan_main_wait
+{
+    wait_queue_t wait;
+    u64 wake_ns;
+} wlan_main_wait;
+
+/** 
+ *  @brief Wake function of the main thread, records when it was woken
+ *  
+ *  @param wait    A pointer to wait_queue_t
+ *  @param mode    Wakeup mode
+ *  @param sync    Sync wakeup flag
+ *  @param key     Wakeup key
+ *  @return        1 if the thread was woken up, 0 otherwise
+ */
+static int
+wlan_main_thread_wake(wait_queue_t * wait, unsigned mode, int sync, void *key)
+{
+    wlan_main_wait *w = container_of(wait, wlan_main_wait, wait);
+    int ret;
+
+    ret = default_wake_function(wait, mode, sync, key);
+    if (ret && !w->wake_ns)
+        w->wake_ns = sched_clock();
+
+    return ret;
+}
+
+/** 
+ *  @brief Update the wakeup to run latency statistics
+ *  
+ *  @param Adapter A pointer to wlan_adapter structure
+ *  @param w       A pointer to wlan_main_wait structure
+ *  @return        n/a
+ */
+static void
+wlan_main_thread_latency(wlan_adapter * Adapter, wlan_main_wait * w)
+{
+    wlan_dbg *dbg = &Adapter->dbg;
+    u32 lat;
+
+    if (!w->wake_ns)
+        return;
+
+    lat = (u32) div_u64(sched_clock() - w->wake_ns, NSEC_PER_USEC);
+    w->wake_ns = 0;
+
+    dbg->num_main_wakeup++;
+    dbg->main_lat_last_us = lat;
+    if (lat > dbg->main_lat_max_us)
+        dbg->main_lat_max_us = lat;
+    if (dbg->num_main_wakeup == 1)
+        dbg->main_lat_avg_us = lat;
+    else
+        dbg->main_lat_avg_us = dbg->main_lat_avg_us - (dbg->main_lat_avg_us >> 3)
+            + (lat >> 3);
+}
+
+/** 
+ *  @brief Apply main_thread_policy and main_thread_priority to the
+ *  current thread when they changed
+ *  
+ *  @param policy    Policy currently applied
+ *  @param priority  Priority currently applied
+ *  @return        n/a
+ */
+static void
+wlan_main_thread_setsched(unsigned int *policy, unsigned int *priority)
+{
+    struct sched_param param;
+    int ret;
+
+    if (main_thread_policy == *policy && main_thread_priority == *priority)
+        return;
+
+    *policy = main_thread_policy;
+    *priority = main_thread_priority;
+
+    param.sched_priority = (*policy == SCHED_NORMAL) ? 0 : *priority;
+    ret = sched_setscheduler(current, *policy, &param);
+    if (ret)
+        PRINTM(MSG, "main-thread: cannot set policy %u priority %u: %d\n",
+               *policy, *priority, ret);
+    else
+        PRINTM(MSG, "main-thread: policy %u priority %u\n",
+               *policy, *priority);
+}
+
 /** 
  *  @brief This function handles the major job in WLAN driver.
  *  it handles the event generated by firmware, rx data received
@@ -703,7 +792,9 @@ wlan_service_main_thread(void *data)
     wlan_thread *thread = data;
     wlan_private *priv = thread->priv;
     wlan_adapter *Adapter = priv->adapter;
-    wait_queue_t wait;
+    wlan_main_wait main_wait = { .wake_ns = 0 };
+    wait_queue_t *wait = &main_wait.wait;
+    unsigned int policy = SCHED_NORMAL, priority = 0;
     u8 ireg = 0;
     unsigned long driver_flags;
 
@@ -713,7 +804,8 @@ wlan_service_main_thread(void *data)
 
     wlan_activate_thread(thread);
 
-    init_waitqueue_entry(&wait, current);
+    init_waitqueue_func_entry(wait, wlan_main_thread_wake);
+    wait->private = current;
 
 #if LINUX_VERSION_CODE >= KERNEL_VERSION(2,5,0)
     current->flags |= PF_NOFREEZE;
@@ -753,7 +845,8 @@ wlan_service_main_thread(void *data)
                   Adapter->WakeupTries);
         }
 
-        add_wait_queue(&thread->waitQ, &wait);
+        wlan_main_thread_setsched(&policy, &priority);
+        add_wait_queue(&thread->waitQ, wait);
         OS_SET_THREAD_STATE(TASK_INTERRUPTIBLE);
 
         TX_DISABLE;
@@ -795,7 +888,8 @@ wlan_service_main_thread(void *data)
         }
 
         OS_SET_THREAD_STATE(TASK_RUNNING);
-        remove_wait_queue(&thread->waitQ, &wait);
+        remove_wait_queue(&thread->waitQ, wait);
+        wlan_main_thread_latency(Adapter, &main_wait);
 
 #if LINUX_VERSION_CODE < KERNEL_VERSION(2,5,0)
         if ((thread->state == WLAN_THREAD_STOPPED) || Adapter->SurpriseRemoved)
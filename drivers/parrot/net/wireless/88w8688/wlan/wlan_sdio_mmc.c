@@ -26,6 +26,7 @@ Change log:
 #include	"wlan_sdio_mmc.h"
 
 #include <linux/firmware.h>
+#include <linux/ktime.h>
 
 /** define SDIO block size */
 /* We support up to 480-byte block size due to FW buffer limitation. */
@@ -152,6 +153,28 @@ sd_read_firmware_status(wlan_private * priv, u16 * dat)
     return WLAN_STATUS_SUCCESS;
 }
 
+/** 
+ *  @brief This function waits between two polls of a card register.
+ *  The first polls spin since the card usually answers within a few
+ *  microseconds; later ones sleep with a doubling delay so that the CPU
+ *  is left to other probes while the card is busy flashing a block.
+ *  
+ *  @param tries   	Number of polls done so far
+ *  @param delay   	A pointer to the current back-off, in microseconds
+ *  @return 	   	n/a
+ */
+static void
+mv_sdio_poll_backoff(int tries, unsigned long *delay)
+{
+    if (tries < POLL_SPIN_TRIES) {
+        udelay(10);
+        return;
+    }
+
+    usleep_range(*delay, *delay * 2);
+    *delay = min(*delay * 2, (unsigned long) POLL_MAX_BACKOFF_US);
+}
+
 /** 
  *  @brief This function polls the card status register.
  *  
@@ -162,6 +185,7 @@ sd_read_firmware_status(wlan_private * priv, u16 * dat)
 static int
 mv_sdio_poll_card_status(wlan_private * priv, u8 bits)
 {
+    unsigned long delay = POLL_MIN_BACKOFF_US;
     int tries;
     u8 cs;
 
@@ -174,7 +198,7 @@ mv_sdio_poll_card_status(wlan_private * priv, u8 bits)
             LEAVE();
             return WLAN_STATUS_SUCCESS;
         }
-        udelay(10);
+        mv_sdio_poll_backoff(tries, &delay);
     }
 
     PRINTM(WARN, "mv_sdio_poll_card_status failed, tries = %d\n", tries);
@@ -1383,6 +1407,8 @@ sbi_prog_fw_w_helper(wlan_private * priv)
     int tx_blocks = 0;
     int i = 0;
     int tries = 0;
+    unsigned long delay;
+    ktime_t start = ktime_get();
 
     ENTER();
 
@@ -1439,6 +1465,7 @@ sbi_prog_fw_w_helper(wlan_private * priv)
         if (offset >= firmwarelen)
             break;
 
+        delay = POLL_MIN_BACKOFF_US;
         for (tries = 0; tries < MAX_POLL_TRIES; tries++) {
             if ((ret = sbi_read_ioreg(priv, HOST_F1_RD_BASE_0, &base0)) < 0) {
                 PRINTM(WARN, "Dev BASE0 register read failed:"
@@ -1462,7 +1489,7 @@ sbi_prog_fw_w_helper(wlan_private * priv)
                could be 1 or 2 (Func1 or Func2). */
             if ((len && offset) || (len > 2))
                 break;
-            udelay(10);
+            mv_sdio_poll_backoff(tries, &delay);
         }
 
         if (len == 0)
@@ -1520,7 +1547,8 @@ sbi_prog_fw_w_helper(wlan_private * priv)
         offset += txlen;
     } while (TRUE);
 
-    PRINTM(INFO, "\nFW download over, size %d bytes\n", offset);
+    PRINTM(MSG, "FW download over, size %d bytes in %lld us\n", offset,
+           (long long) ktime_us_delta(ktime_get(), start));
 
     ret = WLAN_STATUS_SUCCESS;
   done:
@@ -77,7 +77,19 @@ unsigned int logWmiRawMsgs = 0;
 unsigned int enabletimerwar = 0;
 unsigned int fwmode = 1;
 unsigned int mbox_yield_limit = 99;
+/* Link quality events, see AR6000_LINK_QUALITY_EVENTID */
+unsigned int lqinterval = 0;        /* stats sampling period (ms), 0 = off */
+unsigned int lqmininterval = 50;    /* minimum time between two reports (ms) */
+unsigned int lqrssidelta = 3;       /* RSSI change that triggers a report */
+unsigned int lqretrythresh = 16;    /* TX retries that trigger a report */
+unsigned int lqfailthresh = 1;      /* TX failures that trigger a report */
 int reduce_credit_dribble = 1 + HTC_CONNECT_FLAGS_THRESHOLD_LEVEL_ONE_HALF;
+/* RX delivery, see ar6000_rx_poll() */
+unsigned int rx_napi_weight = 16;   /* frames per poll, set at device creation */
+unsigned int rx_backlog = 256;      /* frames queued before dropping */
+unsigned int rx_polls = 0;
+unsigned int rx_budget_exhausted = 0;
+unsigned int rx_backlog_drops = 0;
 int allow_trace_signal = 0;
 /* ATHENV */
 #ifdef ANDROID_ENV
@@ -116,9 +128,19 @@ module_param(enableuartprint, int, 0644);
 module_param(enabletimerwar, int, 0644);
 module_param(fwmode, int, 0644);
 module_param(mbox_yield_limit, int, 0644);
+module_param(lqinterval, uint, 0644);
+module_param(lqmininterval, uint, 0644);
+module_param(lqrssidelta, uint, 0644);
+module_param(lqretrythresh, uint, 0644);
+module_param(lqfailthresh, uint, 0644);
 module_param(reduce_credit_dribble, int, 0644);
 module_param(allow_trace_signal, int, 0644);
 module_param(processDot11Hdr, int, 0644);
+module_param(rx_napi_weight, uint, S_IRUGO);
+module_param(rx_backlog, uint, 0644);
+module_param(rx_polls, uint, S_IRUGO);
+module_param(rx_budget_exhausted, uint, S_IRUGO);
+module_param(rx_backlog_drops, uint, S_IRUGO);
 /* ATHENV */
 #ifdef ANDROID_ENV
 module_param(work_mode, int, 0644);
@@ -267,6 +289,7 @@ static struct net_device_stats *ar6000_get_stats(struct net_device *dev);
 static struct iw_statistics *ar6000_get_iwstats(struct net_device * dev);
 
 static void disconnect_timer_handler(unsigned long ptr);
+static void ar6000_lq_timer_handler(unsigned long ptr);
 
 /*
  * HTC service connection handlers
@@ -286,6 +309,9 @@ static void ar6000_tx_complete(void *Context, HTC_PACKET *pPacket);
 static HTC_SEND_FULL_ACTION ar6000_tx_queue_full(void *Context, HTC_PACKET *pPacket);
 
 static void deliver_frames_to_nw_stack(struct sk_buff *skb);
+#ifdef AR6000_RX_NAPI
+static int ar6000_rx_poll(struct napi_struct *napi, int budget);
+#endif
 
 /*
  * Static variables
@@ -642,6 +668,8 @@ ar6000_cleanup_module(void)
 
     HIFShutDownDevice(NULL);
 
+    BMICleanup();
+
     AR_DEBUG_PRINTF("ar6000_cleanup: success\n");
 }
 
@@ -958,6 +986,13 @@ ar6000_avail_ev(void *context, void *hif_handle)
 #endif /* ADAPTIVE_POWER_THROUGHPUT_CONTROL */
 
     A_INIT_TIMER(&ar->disconnect_timer, disconnect_timer_handler, dev);
+    A_INIT_TIMER(&ar->arLqTimer, ar6000_lq_timer_handler, dev);
+
+#ifdef AR6000_RX_NAPI
+    skb_queue_head_init(&ar->arRxQueue);
+    netif_napi_add(dev, &ar->arNapi, ar6000_rx_poll,
+                   rx_napi_weight ? rx_napi_weight : 1);
+#endif
 
     /*
      * If requested, perform some magic which requires no cooperation from
@@ -1387,6 +1422,7 @@ ar6000_destroy(struct net_device *dev, unsigned int unregister)
     }
 
     ar->bIsDestroyProgress = TRUE;
+    del_timer_sync(&ar->arLqTimer);
 
     if (down_interruptible(&ar->arSem)) {
         AR_DEBUG_PRINTF("%s(): down_interruptible failed \n", __func__);
@@ -1483,6 +1519,10 @@ ar6000_destroy(struct net_device *dev, unsigned int unregister)
     /* Free up the device data structure */
     if( unregister )
         unregister_netdev(dev);
+#ifdef AR6000_RX_NAPI
+    netif_napi_del(&ar->arNapi);
+    skb_queue_purge(&ar->arRxQueue);
+#endif
 #ifndef free_netdev
     kfree(dev);
 #else
@@ -1621,6 +1661,10 @@ ar6000_open(struct net_device *dev)
     unsigned long  flags;
     AR_SOFTC_T    *ar = (AR_SOFTC_T *)netdev_priv(dev);
 
+#ifdef AR6000_RX_NAPI
+    napi_enable(&ar->arNapi);
+#endif
+
     spin_lock_irqsave(&ar->arLock, flags);
     if( ar->arConnected || bypasswmi) {
         netif_carrier_on(dev);
@@ -1637,8 +1681,17 @@ ar6000_open(struct net_device *dev)
 static int
 ar6000_close(struct net_device *dev)
 {
+#ifdef AR6000_RX_NAPI
+    AR_SOFTC_T    *ar = (AR_SOFTC_T *)netdev_priv(dev);
+#endif
+
     netif_stop_queue(dev);
 
+#ifdef AR6000_RX_NAPI
+    napi_disable(&ar->arNapi);
+    skb_queue_purge(&ar->arRxQueue);
+#endif
+
     return 0;
 }
 
@@ -2822,13 +2875,70 @@ refill:
 
 }
 
+#ifdef AR6000_RX_NAPI
+/*
+ * Queue a frame for ar6000_rx_poll(). HTC completes receives from the
+ * SDIO threads, so the softirq is run when bottom halves are re-enabled
+ * rather than at the next interrupt.
+ */
+static void
+ar6000_rx_queue(struct sk_buff *skb)
+{
+    AR_SOFTC_T *ar = (AR_SOFTC_T *)netdev_priv(skb->dev);
+
+    if (skb_queue_len(&ar->arRxQueue) >= rx_backlog) {
+        rx_backlog_drops++;
+        AR6000_STAT_INC(ar, rx_dropped);
+        A_NETBUF_FREE(skb);
+        return;
+    }
+
+    skb_queue_tail(&ar->arRxQueue, skb);
+
+    local_bh_disable();
+    napi_schedule(&ar->arNapi);
+    local_bh_enable();
+}
+
+/* hand at most budget frames to the stack */
+static int
+ar6000_rx_poll(struct napi_struct *napi, int budget)
+{
+    AR_SOFTC_T *ar = container_of(napi, AR_SOFTC_T, arNapi);
+    struct sk_buff *skb;
+    int done = 0;
+
+    rx_polls++;
+
+    while (done < budget && (skb = skb_dequeue(&ar->arRxQueue)) != NULL) {
+        netif_receive_skb(skb);
+        done++;
+    }
+
+    if (done < budget) {
+        napi_complete(napi);
+        /* a frame queued after the last dequeue saw NAPI still scheduled */
+        if (!skb_queue_empty(&ar->arRxQueue))
+            napi_schedule(napi);
+    } else {
+        rx_budget_exhausted++;
+    }
+
+    return done;
+}
+#endif /* AR6000_RX_NAPI */
+
 static void
 deliver_frames_to_nw_stack(struct sk_buff *skb)
 {
     if(skb) {
         if ((skb->dev->flags & IFF_UP) == IFF_UP) {
             skb->protocol = eth_type_trans(skb, skb->dev);
+#ifdef AR6000_RX_NAPI
+            ar6000_rx_queue(skb);
+#else
             netif_rx(skb);
+#endif
         } else {
             A_NETBUF_FREE(skb);
         }
@@ -3182,6 +3292,10 @@ ar6000_connect_event(AR_SOFTC_T *ar, A_UINT16 channel, A_UINT8 *bssid,
 
     reconnect_flag = 0;
 
+    if (lqinterval) {
+        A_TIMEOUT_MS(&ar->arLqTimer, lqinterval, 0);
+    }
+
     A_MEMZERO(&wrqu, sizeof(wrqu));
     A_MEMCPY(wrqu.addr.sa_data, bssid, IEEE80211_ADDR_LEN);
     wrqu.addr.sa_family = ARPHRD_ETHER;
@@ -3448,13 +3562,109 @@ ar6000_scanComplete_event(AR_SOFTC_T *ar, A_STATUS status)
     wake_up_interruptible(&ar6000_scan_queue);
 }
 
+/*
+ * Compare the last target statistics against what was reported to the
+ * application and push a link quality event when a threshold is crossed.
+ * A crossing that falls within lqmininterval of the previous report is
+ * not lost: it is compared again on the next statistics update.
+ */
+static void
+ar6000_lq_update(AR_SOFTC_T *ar)
+{
+    TARGET_STATS *pStats = &ar->arTargetStats;
+    AR6000_LINK_QUALITY_EVENT event;
+    A_UINT64 retries, failures, bmiss;
+
+    if (!ar->arConnected || ar->bIsDestroyProgress) {
+        return;
+    }
+
+    /* Counters go back to zero when the application clears the stats */
+    if (pStats->tx_retry_cnt < ar->arLqTxRetries ||
+        pStats->tx_failed_cnt < ar->arLqTxFailures ||
+        pStats->cs_bmiss_cnt < ar->arLqBmiss)
+    {
+        ar->arLqTxRetries = pStats->tx_retry_cnt;
+        ar->arLqTxFailures = pStats->tx_failed_cnt;
+        ar->arLqBmiss = pStats->cs_bmiss_cnt;
+    }
+
+    if (time_before(jiffies, ar->arLqLastReport +
+                    msecs_to_jiffies(lqmininterval)))
+    {
+        return;
+    }
+
+    retries = pStats->tx_retry_cnt - ar->arLqTxRetries;
+    failures = pStats->tx_failed_cnt - ar->arLqTxFailures;
+    bmiss = pStats->cs_bmiss_cnt - ar->arLqBmiss;
+
+    A_MEMZERO(&event, sizeof(event));
+    if (abs(pStats->cs_aveBeacon_rssi - ar->arLqRssi) >= lqrssidelta) {
+        event.reason |= AR6000_LQ_REASON_RSSI;
+    }
+    if (pStats->tx_unicast_rate != ar->arLqTxRate) {
+        event.reason |= AR6000_LQ_REASON_RATE;
+    }
+    if (lqretrythresh && retries >= lqretrythresh) {
+        event.reason |= AR6000_LQ_REASON_RETRY;
+    }
+    if (lqfailthresh && failures >= lqfailthresh) {
+        event.reason |= AR6000_LQ_REASON_FAILURE;
+    }
+    if (!event.reason) {
+        return;
+    }
+
+    event.rssi = pStats->cs_aveBeacon_rssi;
+    event.snr = pStats->cs_aveBeacon_snr;
+    event.txRate = pStats->tx_unicast_rate;
+    event.txRetries = retries;
+    event.txFailures = failures;
+    event.beaconMisses = bmiss;
+
+    ar->arLqLastReport = jiffies;
+    ar->arLqRssi = pStats->cs_aveBeacon_rssi;
+    ar->arLqTxRate = pStats->tx_unicast_rate;
+    ar->arLqTxRetries = pStats->tx_retry_cnt;
+    ar->arLqTxFailures = pStats->tx_failed_cnt;
+    ar->arLqBmiss = pStats->cs_bmiss_cnt;
+
+    ar6000_send_event_to_app(ar, AR6000_LINK_QUALITY_EVENTID,
+                             (A_UINT8 *)&event, sizeof(event));
+}
+
+/*
+ * The target only reports statistics on request: sample them every
+ * lqinterval ms while connected so that ar6000_lq_update() can see the
+ * link degrade without the application polling SIOCGIWSTATS.
+ */
+static void
+ar6000_lq_timer_handler(unsigned long ptr)
+{
+    struct net_device *dev = (struct net_device *)ptr;
+    AR_SOFTC_T *ar = (AR_SOFTC_T *)netdev_priv(dev);
+
+    if (!lqinterval || !ar->arConnected || ar->bIsDestroyProgress ||
+        ar->arWmiReady == FALSE)
+    {
+        return;
+    }
+
+    if (wmi_get_stats_cmd(ar->arWmi) != A_OK) {
+        AR_DEBUG2_PRINTF("ar6000: link quality stats request failed\n");
+    }
+
+    A_TIMEOUT_MS(&ar->arLqTimer, lqinterval, 0);
+}
+
 void
 ar6000_targetStats_event(AR_SOFTC_T *ar,  WMI_TARGET_STATS *pTarget)
 {
     TARGET_STATS *pStats = &ar->arTargetStats;
     A_UINT8 ac;
 
-    A_PRINTF("AR6000 updating target stats\n");
+    AR_DEBUG2_PRINTF("AR6000 updating target stats\n");
     pStats->tx_packets          += pTarget->txrxStats.tx_stats.tx_packets;
     pStats->tx_bytes            += pTarget->txrxStats.tx_stats.tx_bytes;
     pStats->tx_unicast_pkts     += pTarget->txrxStats.tx_stats.tx_unicast_pkts;
@@ -3526,6 +3736,8 @@ ar6000_targetStats_event(AR_SOFTC_T *ar,  WMI_TARGET_STATS *pTarget)
 
     ar->statsUpdatePending = FALSE;
     wake_up(&arEvent);
+
+    ar6000_lq_update(ar);
 }
 
 void
@@ -3538,6 +3750,11 @@ ar6000_rssiThreshold_event(AR_SOFTC_T *ar,  WMI_RSSI_THRESHOLD_VAL newThreshold,
     userRssiThold.rssi = rssi + SIGNAL_QUALITY_NOISE_FLOOR;
     A_PRINTF("rssi Threshold range = %d tag = %d  rssi = %d\n", newThreshold,
              userRssiThold.tag, userRssiThold.rssi);
+
+    /* Get the counters that go with it out without waiting for a sample */
+    if (lqinterval && ar->arWmiReady == TRUE) {
+        wmi_get_stats_cmd(ar->arWmi);
+    }
 #ifdef SEND_EVENT_TO_APP
     ar6000_send_event_to_app(ar, WMI_RSSI_THRESHOLD_EVENTID,(A_UINT8 *)&userRssiThold, sizeof(USER_RSSI_THOLD));
 #endif
@@ -58,6 +58,11 @@
 #include "gpio_api.h"
 #include "gpio.h"
 #include <host_version.h>
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(2,6,24)
+/* received frames are handed to the stack from a NAPI poll */
+#define AR6000_RX_NAPI
+#endif
 #include <linux/rtnetlink.h>
 #if LINUX_VERSION_CODE < KERNEL_VERSION(2,6,0)
 #include <asm/uaccess.h>
@@ -347,6 +352,17 @@ typedef struct ar6_softc {
     A_UINT8                 intra_bss;   /* enable/disable intra bss data forward */
     A_BOOL                  bIsDestroyProgress; /* flag to indicate ar6k destroy is in progress */
     A_TIMER                 disconnect_timer;
+    A_TIMER                 arLqTimer;          /* link quality sampling */
+    unsigned long           arLqLastReport;     /* jiffies */
+    A_INT16                 arLqRssi;           /* values at the last report */
+    A_INT32                 arLqTxRate;
+    A_UINT64                arLqTxRetries;
+    A_UINT64                arLqTxFailures;
+    A_UINT64                arLqBmiss;
+#ifdef AR6000_RX_NAPI
+    struct napi_struct      arNapi;
+    struct sk_buff_head     arRxQueue;          /* frames waiting for the poll */
+#endif
 } AR_SOFTC_T;
 
 #if LINUX_VERSION_CODE < KERNEL_VERSION(2,6,0)
@@ -1050,6 +1050,30 @@ typedef struct user_rssi_params_t {
     USER_RSSI_THOLD    tholds[12];
 } USER_RSSI_PARAMS;
 
+/*
+ * Link quality report, sent as an IWEVCUSTOM wireless event whose payload
+ * starts with the 16-bit AR6000_LINK_QUALITY_EVENTID. Reports are sent
+ * when one of the lq* module parameter thresholds is crossed, at most once
+ * every lqmininterval ms. The counters are deltas since the previous
+ * report.
+ */
+#define AR6000_LINK_QUALITY_EVENTID             0x8001
+
+#define AR6000_LQ_REASON_RSSI                   0x01
+#define AR6000_LQ_REASON_RATE                   0x02
+#define AR6000_LQ_REASON_RETRY                  0x04
+#define AR6000_LQ_REASON_FAILURE                0x08
+
+typedef struct ar6000_link_quality_event_t {
+    A_UINT32    reason;         /* AR6000_LQ_REASON_* bits */
+    A_INT16     rssi;           /* average beacon RSSI, as in iwstats level */
+    A_INT16     snr;            /* average beacon SNR */
+    A_INT32     txRate;         /* current unicast TX rate, kbps */
+    A_UINT32    txRetries;
+    A_UINT32    txFailures;
+    A_UINT32    beaconMisses;
+} AR6000_LINK_QUALITY_EVENT;
+
 /*
  * Host driver may have some config parameters. Typically, these
  * config params are one time config parameters. These could
@@ -1493,7 +1493,6 @@ int ar6000_ioctl(struct net_device *dev, struct ifreq *rq, int cmd)
             AR_DEBUG_PRINTF("Write Memory (address: 0x%x, length: %d)\n",
                              address, length);
             if ((buffer = (unsigned char *)A_MALLOC(length)) != NULL) {
-                A_MEMZERO(buffer, length);
                 if (copy_from_user(buffer, &userdata[sizeof(address) +
                                    sizeof(length)], length))
                 {
@@ -1609,7 +1608,6 @@ int ar6000_ioctl(struct net_device *dev, struct ifreq *rq, int cmd)
             get_user(length, (unsigned int *)userdata);
             AR_DEBUG_PRINTF("Send Compressed Data (length: %d)\n", length);
             if ((buffer = (unsigned char *)A_MALLOC(length)) != NULL) {
-                A_MEMZERO(buffer, length);
                 if (copy_from_user(buffer, &userdata[sizeof(length)], length))
                 {
                     ret = -EFAULT;
@@ -23,6 +23,8 @@
 #include "htc_api.h"
 #include "bmi_internal.h"
 #include "AR6002/hw/mbox_host_reg.h"
+#include <linux/debugfs.h>
+#include <linux/ktime.h>
 
 /*
 Although we had envisioned BMI to run on top of HTC, this is not how the
@@ -32,13 +34,79 @@ very simple.
 */
 
 static A_BOOL pendingEventsFuncCheck = FALSE; 
-    
+
+/*
+ * The mailbox address does not change for the lifetime of a device, so it is
+ * looked up on the first BMI access after BMIInit rather than on every
+ * command.
+ */
+static A_BOOL mboxAddressCheck = FALSE;
+static A_UINT32 mboxAddress[HTC_MAILBOX_NUM_MAX];
+
+/*
+ * Single command buffer shared by the streaming commands. BMI is strictly
+ * sequential (one outstanding command, driven from probe or from the
+ * loader ioctls), so there is no need for one static buffer per command.
+ */
+static A_UCHAR bmiCommandBuffer[BMI_DATASZ_MAX + 3 * sizeof(A_UINT32)];
+
+/* Download statistics, reset on BMIInit and exported in debugfs */
+static struct {
+    A_UINT32 bytes;         /* payload bytes streamed to the Target */
+    A_UINT32 commands;      /* BMI commands sent */
+    A_UINT32 creditPolls;   /* credit register reads that found no credit */
+    A_UINT32 streamUs;      /* time spent in BMIWriteMemory/BMILZData */
+    A_UINT32 downloadUs;    /* BMIInit to BMIDone */
+    ktime_t start;
+} bmiStats;
+
+static struct dentry *bmiDebugDir;
+
+static void
+bmiDebugInit(void)
+{
+    bmiDebugDir = debugfs_create_dir("ar6000_bmi", NULL);
+    if (IS_ERR_OR_NULL(bmiDebugDir)) {
+        bmiDebugDir = NULL;
+        return;
+    }
+
+    debugfs_create_u32("bytes", S_IRUGO, bmiDebugDir, &bmiStats.bytes);
+    debugfs_create_u32("commands", S_IRUGO, bmiDebugDir, &bmiStats.commands);
+    debugfs_create_u32("credit_polls", S_IRUGO, bmiDebugDir,
+                       &bmiStats.creditPolls);
+    debugfs_create_u32("stream_us", S_IRUGO, bmiDebugDir, &bmiStats.streamUs);
+    debugfs_create_u32("download_us", S_IRUGO, bmiDebugDir,
+                       &bmiStats.downloadUs);
+}
+
 /* APIs visible to the driver */
 void
 BMIInit(void)
 {
     bmiDone = FALSE;
     pendingEventsFuncCheck = FALSE;
+    mboxAddressCheck = FALSE;
+
+    bmiStats.bytes = 0;
+    bmiStats.commands = 0;
+    bmiStats.creditPolls = 0;
+    bmiStats.streamUs = 0;
+    bmiStats.downloadUs = 0;
+    bmiStats.start = ktime_get();
+
+    if (bmiDebugDir == NULL) {
+        bmiDebugInit();
+    }
+}
+
+void
+BMICleanup(void)
+{
+    if (bmiDebugDir != NULL) {
+        debugfs_remove_recursive(bmiDebugDir);
+        bmiDebugDir = NULL;
+    }
 }
 
 A_STATUS
@@ -61,7 +129,9 @@ BMIDone(HIF_DEVICE *device)
         AR_DEBUG_PRINTF(ATH_DEBUG_ERR, ("Unable to write to the device\n"));
         return A_ERROR;
     }
-    AR_DEBUG_PRINTF(ATH_DEBUG_BMI, ("BMI Done: Exit\n"));
+    bmiStats.downloadUs = ktime_us_delta(ktime_get(), bmiStats.start);
+    AR_DEBUG_PRINTF(ATH_DEBUG_BMI, ("BMI Done: Exit (%u bytes, %u commands, %u us)\n",
+                    bmiStats.bytes, bmiStats.commands, bmiStats.downloadUs));
 
     return A_OK;
 }
@@ -133,6 +203,58 @@ BMIGetTargetInfo(HIF_DEVICE *device, struct bmi_target_info *targ_info)
     return A_OK;
 }
 
+/*
+ * Stream a buffer to the Target as a train of BMI commands of the form
+ * { cid, [address], length, data }. The Target's BMI command buffer is
+ * BMI_DATASZ_MAX bytes, so each command carries at most BMI_DATASZ_MAX minus
+ * the header; the header is only built once though, and just the length
+ * (and address, when there is one) is patched between two chunks.
+ */
+static A_STATUS
+bmiStreamData(HIF_DEVICE *device,
+              A_UINT32 cid,
+              A_UINT32 *address,
+              A_UCHAR *buffer,
+              A_UINT32 length)
+{
+    A_STATUS status = A_OK;
+    A_UINT32 header, lengthOffset;
+    A_UINT32 remaining, txlen;
+    ktime_t start = ktime_get();
+
+    lengthOffset = sizeof(cid) + (address ? sizeof(*address) : 0);
+    header = lengthOffset + sizeof(length);
+
+    A_MEMCPY(&bmiCommandBuffer[0], &cid, sizeof(cid));
+
+    remaining = length;
+    while (remaining)
+    {
+        txlen = (remaining < (BMI_DATASZ_MAX - header)) ?
+                                       remaining : (BMI_DATASZ_MAX - header);
+        if (address) {
+            A_MEMCPY(&bmiCommandBuffer[sizeof(cid)], address, sizeof(*address));
+        }
+        A_MEMCPY(&bmiCommandBuffer[lengthOffset], &txlen, sizeof(txlen));
+        A_MEMCPY(&bmiCommandBuffer[header], &buffer[length - remaining], txlen);
+        status = bmiBufferSend(device, bmiCommandBuffer, header + txlen);
+        if (status != A_OK) {
+            AR_DEBUG_PRINTF(ATH_DEBUG_ERR, ("Unable to write to the device\n"));
+            status = A_ERROR;
+            break;
+        }
+        bmiStats.bytes += txlen;
+        remaining -= txlen;
+        if (address) {
+            *address += txlen;
+        }
+    }
+
+    bmiStats.streamUs += ktime_us_delta(ktime_get(), start);
+
+    return status;
+}
+
 A_STATUS
 BMIReadMemory(HIF_DEVICE *device,
               A_UINT32 address,
@@ -194,13 +316,7 @@ BMIWriteMemory(HIF_DEVICE *device,
                A_UCHAR *buffer,
                A_UINT32 length)
 {
-    A_UINT32 cid;
     A_STATUS status;
-    A_UINT32 offset;
-    A_UINT32 remaining, txlen;
-    const A_UINT32 header = sizeof(cid) + sizeof(address) + sizeof(length);
-    static A_UCHAR data[BMI_DATASZ_MAX + sizeof(cid) + sizeof(address) + sizeof(length)];
-	memset (&data, 0, BMI_DATASZ_MAX+header);
 
     if (bmiDone) {
         AR_DEBUG_PRINTF(ATH_DEBUG_ERR, ("Command disallowed\n"));
@@ -211,28 +327,9 @@ BMIWriteMemory(HIF_DEVICE *device,
          ("BMI Write Memory: Enter (device: 0x%p, address: 0x%x, length: %d)\n",
          device, address, length));
 
-    cid = BMI_WRITE_MEMORY;
-
-    remaining = length;
-    while (remaining)
-    {
-        txlen = (remaining < (BMI_DATASZ_MAX - header)) ?
-                                       remaining : (BMI_DATASZ_MAX - header);
-        offset = 0;
-        A_MEMCPY(&data[offset], &cid, sizeof(cid));
-        offset += sizeof(cid);
-        A_MEMCPY(&data[offset], &address, sizeof(address));
-        offset += sizeof(address);
-        A_MEMCPY(&data[offset], &txlen, sizeof(txlen));
-        offset += sizeof(txlen);
-        A_MEMCPY(&data[offset], &buffer[length - remaining], txlen);
-        offset += txlen;
-        status = bmiBufferSend(device, data, offset);
-        if (status != A_OK) {
-            AR_DEBUG_PRINTF(ATH_DEBUG_ERR, ("Unable to write to the device\n"));
-            return A_ERROR;
-        }
-        remaining -= txlen; address += txlen;
+    status = bmiStreamData(device, BMI_WRITE_MEMORY, &address, buffer, length);
+    if (status != A_OK) {
+        return A_ERROR;
     }
 
     AR_DEBUG_PRINTF(ATH_DEBUG_BMI, ("BMI Write Memory: Exit\n"));
@@ -564,14 +661,7 @@ BMILZData(HIF_DEVICE *device,
           A_UCHAR *buffer,
           A_UINT32 length)
 {
-    A_UINT32 cid;
     A_STATUS status;
-    A_UINT32 offset;
-    A_UINT32 remaining, txlen;
-    const A_UINT32 header = sizeof(cid) + sizeof(length);
-    static A_UCHAR data[BMI_DATASZ_MAX + sizeof(cid) + sizeof(length)];
-
-    memset (&data, 0, BMI_DATASZ_MAX+header);
 
     if (bmiDone) {
         AR_DEBUG_PRINTF(ATH_DEBUG_ERR, ("Command disallowed\n"));
@@ -582,26 +672,9 @@ BMILZData(HIF_DEVICE *device,
          ("BMI Send LZ Data: Enter (device: 0x%p, length: %d)\n",
          device, length));
 
-    cid = BMI_LZ_DATA;
-
-    remaining = length;
-    while (remaining)
-    {
-        txlen = (remaining < (BMI_DATASZ_MAX - header)) ?
-                                       remaining : (BMI_DATASZ_MAX - header);
-        offset = 0;
-        A_MEMCPY(&data[offset], &cid, sizeof(cid));
-        offset += sizeof(cid);
-        A_MEMCPY(&data[offset], &txlen, sizeof(txlen));
-        offset += sizeof(txlen);
-        A_MEMCPY(&data[offset], &buffer[length - remaining], txlen);
-        offset += txlen;
-        status = bmiBufferSend(device, data, offset);
-        if (status != A_OK) {
-            AR_DEBUG_PRINTF(ATH_DEBUG_ERR, ("Unable to write to the device\n"));
-            return A_ERROR;
-        }
-        remaining -= txlen;
+    status = bmiStreamData(device, BMI_LZ_DATA, NULL, buffer, length);
+    if (status != A_OK) {
+        return A_ERROR;
     }
 
     AR_DEBUG_PRINTF(ATH_DEBUG_BMI, ("BMI LZ Data: Exit\n"));
@@ -654,10 +727,12 @@ bmiBufferSend(HIF_DEVICE *device,
     A_UINT32 timeout;
     A_UINT32 address;
     static A_UINT32 cmdCredits;
-    A_UINT32 mboxAddress[HTC_MAILBOX_NUM_MAX];
 
-    HIFConfigureDevice(device, HIF_DEVICE_GET_MBOX_ADDR,
-                       &mboxAddress[0], sizeof(mboxAddress));
+    if (!mboxAddressCheck) {
+        HIFConfigureDevice(device, HIF_DEVICE_GET_MBOX_ADDR,
+                           &mboxAddress[0], sizeof(mboxAddress));
+        mboxAddressCheck = TRUE;
+    }
 
     cmdCredits = 0;
     timeout = BMI_COMMUNICATION_TIMEOUT;
@@ -676,6 +751,9 @@ bmiBufferSend(HIF_DEVICE *device,
         }
         /* the counter is only 8=bits, ignore anything in the upper 3 bytes */
         cmdCredits &= 0xFF;
+        if (!cmdCredits) {
+            bmiStats.creditPolls++;
+        }
     }
 
     if (cmdCredits) {
@@ -686,6 +764,7 @@ bmiBufferSend(HIF_DEVICE *device,
             AR_DEBUG_PRINTF(ATH_DEBUG_ERR, ("Unable to send the BMI data to the device\n"));
             return A_ERROR;
         }
+        bmiStats.commands++;
     } else {
         AR_DEBUG_PRINTF(ATH_DEBUG_ERR, ("BMI Communication timeout - bmiBufferSend\n"));
         return A_ERROR;
@@ -702,10 +781,9 @@ bmiBufferReceive(HIF_DEVICE *device,
 {
     A_STATUS status;
     A_UINT32 address;
-    A_UINT32 mboxAddress[HTC_MAILBOX_NUM_MAX];
     HIF_PENDING_EVENTS_INFO     hifPendingEvents;
     static HIF_PENDING_EVENTS_FUNC getPendingEventsFunc = NULL;
-    
+
     if (!pendingEventsFuncCheck) {
             /* see if the HIF layer implements an alternative function to get pending events
              * do this only once! */
@@ -715,9 +793,12 @@ bmiBufferReceive(HIF_DEVICE *device,
                            sizeof(getPendingEventsFunc));
         pendingEventsFuncCheck = TRUE;
     }
-                       
-    HIFConfigureDevice(device, HIF_DEVICE_GET_MBOX_ADDR,
-                       &mboxAddress[0], sizeof(mboxAddress));
+
+    if (!mboxAddressCheck) {
+        HIFConfigureDevice(device, HIF_DEVICE_GET_MBOX_ADDR,
+                           &mboxAddress[0], sizeof(mboxAddress));
+        mboxAddressCheck = TRUE;
+    }
 
     /*
      * During normal bootup, small reads may be required.
@@ -36,6 +36,9 @@ extern "C" {
 void
 BMIInit(void);
 
+void
+BMICleanup(void);
+
 A_STATUS
 BMIDone(HIF_DEVICE *device);
 
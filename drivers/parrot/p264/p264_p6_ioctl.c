@@ -25,6 +25,8 @@
 #include "p264_p6_ioctl.h"
 #include "P6_h264.h"
 
+#include <trace/events/parrot.h>
+
 // Memory Usage :
 // This module makes the assumption that INTRAM is free at 0x80007000 for 8*ceil(MAX_FRAME_WIDTH(in MBs)/8)*16*4*2 = 3072 bytes
 // Input and output frame buffers are allocated in user space with dmaalloc, only physical address are transmitted to the module
@@ -176,8 +178,12 @@ static int p264_ioctl(struct inode *inode, struct file *filp,
     void __user *arg_struct = (void __user *)arg;
 
     // test whether fiq is done
-    if (picture_encoding_context.nb_mb_to_encode == picture_encoding_context.nb_mb_encoded)
+    if (picture_encoding_context.is_running &&
+        picture_encoding_context.nb_mb_to_encode == picture_encoding_context.nb_mb_encoded)
+    {
       picture_encoding_context.is_running = false;
+      trace_p264_job_end(picture_encoding_context.nb_mb_encoded);
+    }
 
     switch (cmd)
     {
@@ -366,6 +372,9 @@ static int p264_ioctl(struct inode *inode, struct file *filp,
             __raw_writel((picture_encoding_context.current_j_MB<<24)|(picture_encoding_context.current_i_MB<<16)|(picture_encoding_context.current_j_MB<<8)|picture_encoding_context.current_i_MB, ui_h264_reg+H264_MB_ADDR);
             // launch H264 IP
             __raw_writel( 0, ui_h264_reg+H264_START);
+            trace_p264_job_start(picture_encoding_context.current_i_MB,
+                                 picture_encoding_context.current_j_MB,
+                                 nb_mb, picture_encoding_context.nb_mb_to_encode);
 
             picture_encoding_context.is_running = true;
           }
@@ -32,6 +32,7 @@
 
 #include <asm/io.h>
 #include <asm/irq.h>
+#include <mach/irqs.h>
 
 #include <linux/serial_core.h>
 
@@ -42,16 +43,32 @@
 /* XXX may be use a platform driver for this */
 #ifdef CONFIG_ARCH_PARROT
 #define DCC_IRQ_USED
-#define IRQ_RX 27
-#define IRQ_TX 28
+#ifdef CONFIG_ARCH_PARROT5
+#define IRQ_RX IRQ_P5_COMMRX
+#define IRQ_TX IRQ_P5_COMMTX
+#else
+#define IRQ_RX IRQ_P6_COMMRX
+#define IRQ_TX IRQ_P6_COMMTX
+#endif
 #else
 /* polling mode */
 #define IRQ_RX 0x12345678
 #define IRQ_TX 0
-
-#warning polling mode
 #endif
 
+/* wakeup counters, throughput is in /proc/tty/driver */
+static unsigned int rx_wakeups;
+module_param(rx_wakeups, uint, S_IRUGO);
+MODULE_PARM_DESC(rx_wakeups, "rx interrupts (or polls that received data)");
+
+static unsigned int tx_wakeups;
+module_param(tx_wakeups, uint, S_IRUGO);
+MODULE_PARM_DESC(tx_wakeups, "tx interrupts (or polls that sent data)");
+
+static unsigned int idle_wakeups;
+module_param(idle_wakeups, uint, S_IRUGO);
+MODULE_PARM_DESC(idle_wakeups, "polls that found nothing to do");
+
 #define UART_NR			1	/* we have only one JTAG port */
 
 #ifdef CONFIG_SERIAL_DCC_STDSERIAL
@@ -130,7 +147,7 @@ static void dcc_serial_start_tx(struct uart_port *port)
 static void dcc_serial_stop_tx(struct uart_port *port)
 {
 	if (dcc_serial_tx_enable == TX_ON) {
-		disable_irq(port->irq);
+		disable_irq_nosync(port->irq);
 		dcc_serial_tx_enable = TX_OFF;
 	}
 }
@@ -139,7 +156,7 @@ static void dcc_serial_stop_tx(struct uart_port *port)
 static void dcc_serial_stop_rx(struct uart_port *port)
 {
 	if (dcc_serial_rx_enable == RX_ON) {
-		disable_irq((int)port->membase);
+		disable_irq_nosync((int)port->membase);
 	}
 	dcc_serial_rx_enable = RX_OFF;
 }
@@ -148,7 +165,7 @@ static void dcc_serial_stop_rx(struct uart_port *port)
 static void dcc_serial_throttle_rx(struct uart_port *port, int stop)
 {
 	if (stop && dcc_serial_rx_enable == RX_ON) {
-		disable_irq((int)port->membase);
+		disable_irq_nosync((int)port->membase);
 		dcc_serial_rx_enable = RX_PAUSE;
 	}
 	else if (stop == 0 && dcc_serial_rx_enable == RX_PAUSE) {
@@ -198,6 +215,7 @@ static irqreturn_t dcc_serial_int_rx(int irq, void *dev_id)
 {
 	struct uart_port *port = dev_id;
 	spin_lock(&port->lock);
+	rx_wakeups++;
 	dcc_serial_rx_chars(port);
 	spin_unlock(&port->lock);
 
@@ -208,7 +226,7 @@ static irqreturn_t dcc_serial_int_tx(int irq, void *dev_id)
 {
 	struct uart_port *port = dev_id;
 	spin_lock(&port->lock);
-
+	tx_wakeups++;
 	dcc_serial_tx_chars(port, 64);
 	spin_unlock(&port->lock);
 
@@ -230,8 +248,10 @@ static int dcc_serial_startup(struct uart_port *port)
 	/* Allocate the IRQ */
 	retval = request_irq((int)port->membase, dcc_serial_int_rx, IRQF_DISABLED,
 			     "serial_dcc_serial_rx", port);
-	if (retval)
+	if (retval) {
+		free_irq(port->irq, port);
 		return retval;
+	}
 
 	return 0;
 }
@@ -247,19 +267,24 @@ static DECLARE_DELAYED_WORK(dcc_serial_poll_task, dcc_serial_poll);
 static struct uart_port dcc_serial_port;
 static int dcc_serial_active;
 
-/* in polling mode, we wait for the next character */
-static int dcc_serial_tx_ready(struct uart_port *port) {
-	while (__dcc_getstatus() & DCC_STATUS_TX) {
-		/* while waiting, we can check rx : it is free */
-		dcc_serial_rx_chars(port);
-		cpu_relax();
-	}
-	return 1;
-}
+/*
+ * poll period in jiffies: doubled each time a poll finds nothing to do,
+ * back to 1 as soon as data moves.
+ */
+#define DCC_POLL_MAX		(HZ/2)
+static unsigned long dcc_serial_poll_delay = 1;
 
+/* don't wait for the debugger, the next poll will send the rest */
+#define dcc_serial_tx_ready(port) \
+	((__dcc_getstatus() & DCC_STATUS_TX) == 0)
+
+/* port locked, interrupts locally disabled */
 static void dcc_serial_start_tx(struct uart_port *port)
 {
-	dcc_serial_tx_chars(port, 0xFFFF);
+	/* poll now rather than after the idle backoff */
+	dcc_serial_poll_delay = 1;
+	__cancel_delayed_work(&dcc_serial_poll_task);
+	schedule_delayed_work(&dcc_serial_poll_task, 0);
 }
 
 static void dcc_serial_stop_tx(struct uart_port *port)
@@ -294,34 +319,54 @@ int dcc_idle(void)
 }
 #endif
 
-/* we poll dcc every jiffies */
+/* poll dcc, backing off while it is idle */
 static void dcc_serial_poll(struct work_struct *work)
 {
 	struct uart_port *port = &dcc_serial_port;
+	__u32 rx, tx;
 
-	spin_lock(&port->lock);
+	spin_lock_irq(&port->lock);
+
+	rx = port->icount.rx;
+	tx = port->icount.tx;
 
 	dcc_serial_rx_chars(port);
-	dcc_serial_tx_chars(port, 0xFFFF);
+	dcc_serial_tx_chars(port, 64);
 	dcc_serial_rx_chars(port);
 
-	schedule_delayed_work(&dcc_serial_poll_task, 1);
+	if (port->icount.rx != rx)
+		rx_wakeups++;
+	if (port->icount.tx != tx)
+		tx_wakeups++;
+
+	if (port->icount.rx != rx || port->icount.tx != tx)
+		dcc_serial_poll_delay = 1;
+	else {
+		idle_wakeups++;
+		dcc_serial_poll_delay = min(dcc_serial_poll_delay * 2,
+					    (unsigned long)DCC_POLL_MAX);
+	}
 
-	spin_unlock(&port->lock);
+	if (dcc_serial_active)
+		schedule_delayed_work(&dcc_serial_poll_task,
+				      dcc_serial_poll_delay);
+
+	spin_unlock_irq(&port->lock);
 }
 static int dcc_serial_startup(struct uart_port *port)
 {
 	/* shcedule the polling work */
-	schedule_delayed_work(&dcc_serial_poll_task, 1);
 	dcc_serial_active = 1;
+	dcc_serial_poll_delay = 1;
+	schedule_delayed_work(&dcc_serial_poll_task, 1);
 
 	return 0;
 }
 
 static void dcc_serial_shutdown(struct uart_port *port)
 {
-	cancel_rearming_delayed_work(&dcc_serial_poll_task);
 	dcc_serial_active = 0;
+	cancel_rearming_delayed_work(&dcc_serial_poll_task);
 }
 #endif /* end of DCC_IRQ_USED */
 
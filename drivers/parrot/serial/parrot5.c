@@ -39,6 +39,7 @@
 #include <linux/clk.h>
 #include <linux/mm.h>
 #include <linux/kernel.h>
+#include <linux/ctype.h>
 
 #include <linux/io.h>
 #include <asm/sizes.h>
@@ -63,16 +64,39 @@ module_param_array(low_latency_map, int, NULL, S_IRUGO);
 MODULE_PARM_DESC(low_latency_map, "UARTs low latency enable/disable");
 
 #define UART_SNOOP_PATTERN_MAX_LEN 32 /* must be a power of 2 */
+#define UART_SNOOP_MAX_PATTERNS     4
 
-struct uart_snoop {
+struct uart_snoop_pattern {
 	unsigned int            length;
-	unsigned int            pos;
 	unsigned int            filter_first;
 	unsigned int            filter_last;
 	u16                     pattern[UART_SNOOP_PATTERN_MAX_LEN];
+};
+
+/* layout of the page exported through attribute 'snoop_match' */
+struct uart_snoop_match {
+	u32                     count;
+	u32                     offset;
+	u8                      data[UART_SNOOP_PATTERN_MAX_LEN];
+};
+
+struct uart_snoop_page {
+	u32                     version;
+	u8                      data[UART_SNOOP_PATTERN_MAX_LEN];
+	u32                     index;
+	struct uart_snoop_match match[UART_SNOOP_MAX_PATTERNS];
+};
+
+struct uart_snoop {
+	unsigned int            npatterns;
+	unsigned int            pos;
+	unsigned int            fill;
+	u32                     rx_count;
+	struct uart_snoop_pattern patterns[UART_SNOOP_MAX_PATTERNS];
 	u8                      buffer[UART_SNOOP_PATTERN_MAX_LEN];
 	u32                     version;
-	u8                     *page;
+	struct uart_snoop_page *page;
+	struct sysfs_dirent    *event;
 };
 
 static void parrot5_serial_snoop_match(struct uart_port *port, unsigned char c);
@@ -711,17 +735,19 @@ static int __init parrot5_serial_console_setup(struct console *co,
 #if defined(CONFIG_SERIAL_PARROT5_SNOOP)
 /*
  * When option CONFIG_SERIAL_PARROT5_SNOOP is enabled, a sysfs interface
- * is added for matching a pattern on UART received bytes.
+ * is added for matching patterns on UART received bytes.
  * Detecting a pattern on rx bytes can be useful to trigger actions
  * with low-latency requirements
- * Two new attributes are created:
+ * Three new attributes are created:
  *
  * <uart_sysfs_path>/snoop_pattern
  * <uart_sysfs_path>/snoop_match
+ * <uart_sysfs_path>/snoop_event
  *
- * Writing an hexadecimal string into 'snoop_pattern' activates
+ * Writing hexadecimal strings into 'snoop_pattern' activates
  * pattern matching. Writing a null string disables it.
- * The hexadecimal string should be a sequence of 16-bit unsigned
+ * Up to 4 patterns, separated by spaces or commas, can be matched
+ * concurrently. Each pattern should be a sequence of 16-bit unsigned
  * numbers, each number representing a matched byte; for instance:
  *
  *  ffa3ffb4ffc60000ffaa
@@ -735,49 +761,56 @@ static int __init parrot5_serial_console_setup(struct console *co,
  * The above pattern example matches the following byte sequence:
  * a3 b4 c6 XX aa (XX = don't care)
  *
- * The latest matching sequence can be retrieved by reading (or
+ * The latest matching sequences can be retrieved by reading (or
  * mmapping) attribute 'snoop_match', which is formatted as follows:
  *
  * struct uart_match {
  *         u32 version;
- *         u8  data[32]; // matched sequence cannot currently exceed 32 bytes
+ *         u8  data[32];      // latest match, whatever the pattern
+ *         u32 index;         // index of the pattern which matched last
+ *         struct {
+ *                 u32 count;     // number of matches of this pattern
+ *                 u32 offset;    // rx byte offset of the latest match
+ *                 u8  data[32];  // latest match of this pattern
+ *         } pattern[4];
  * };
  *
- * Field 'version' is incremented each time 'data' is updated;
+ * Field 'version' is incremented each time the page is updated;
  * it can be used to get consistent values when mmap() is used.
+ * Offsets count received bytes since patterns were last written.
+ *
+ * Attribute 'snoop_event' shows the current version and supports
+ * poll(): after reading it, a poll() for POLLPRI|POLLERR returns as
+ * soon as a pattern matches. Reread it from offset 0 to rearm.
  */
 
-static ssize_t parrot5_serial_snoop_pattern_store(struct device *dev,
-						  struct device_attribute *attr,
-						  const char *buf, size_t count)
+static int parrot5_serial_snoop_parse(const char *buf, size_t len,
+				      struct uart_snoop_pattern *sp)
 {
 	int nibble, pos_first, pos_last;
-	unsigned long flags;
-	unsigned int i, j, length;
-	u16 p, pattern[UART_SNOOP_PATTERN_MAX_LEN];
-	struct uart_port *port = (struct uart_port *)dev_get_drvdata(dev);
-	struct uart_parrot5_port *up = (struct uart_parrot5_port *)port;
-	struct uart_snoop *sn = &up->snoop;
+	unsigned int i, j;
+	u16 p;
 
 	pos_first = -1;
 	pos_last  = -1;
 
-	length = count/4;
-	if (length > UART_SNOOP_PATTERN_MAX_LEN)
-		goto bad_pattern;
+	if ((len % 4) || (len/4 > UART_SNOOP_PATTERN_MAX_LEN))
+		return -EINVAL;
+
+	sp->length = len/4;
 
-	for (i = 0; i < length; i++) {
+	for (i = 0; i < sp->length; i++) {
 		p = 0;
 		for (j = 0; j < 4; j++) {
 			nibble = hex_to_bin(buf[4*i+j]);
 			if (nibble < 0)
-				goto bad_pattern;
+				return -EINVAL;
 			p <<= 4;
 			p |= nibble;
 		}
-		pattern[i] = p;
+		sp->pattern[i] = p;
 
-		if (pattern[i] & 0xff00) {
+		if (p & 0xff00) {
 			/* remember the first non-zero mask in pattern */
 			if (pos_first < 0)
 				pos_first = i;
@@ -787,17 +820,65 @@ static ssize_t parrot5_serial_snoop_pattern_store(struct device *dev,
 	}
 
 	if ((pos_first < 0) || (pos_last < 0))
-		goto bad_pattern;
+		return -EINVAL;
+
+	sp->filter_first = (unsigned int)pos_first;
+	sp->filter_last  = (unsigned int)pos_last;
+
+	return 0;
+}
+
+static inline int is_pattern_sep(char c)
+{
+	return isspace(c) || (c == ',');
+}
+
+static ssize_t parrot5_serial_snoop_pattern_store(struct device *dev,
+						  struct device_attribute *attr,
+						  const char *buf, size_t count)
+{
+	unsigned long flags;
+	unsigned int i, len, npatterns;
+	struct uart_snoop_pattern patterns[UART_SNOOP_MAX_PATTERNS];
+	struct uart_port *port = (struct uart_port *)dev_get_drvdata(dev);
+	struct uart_parrot5_port *up = (struct uart_parrot5_port *)port;
+	struct uart_snoop *sn = &up->snoop;
+
+	npatterns = 0;
+	i = 0;
+
+	while (i < count) {
+		if (is_pattern_sep(buf[i])) {
+			i++;
+			continue;
+		}
+
+		if (npatterns >= UART_SNOOP_MAX_PATTERNS)
+			goto bad_pattern;
+
+		for (len = 0; (i+len < count) && !is_pattern_sep(buf[i+len]);
+		     len++)
+			;
+
+		if (parrot5_serial_snoop_parse(&buf[i], len,
+					       &patterns[npatterns]))
+			goto bad_pattern;
+
+		npatterns++;
+		i += len;
+	}
 
 	spin_lock_irqsave(&port->lock, flags);
 
 	sn->version = 0;
 	sn->pos = 0;
-	sn->filter_first = (unsigned int)pos_first;
-	sn->filter_last  = (unsigned int)pos_last;
-	sn->length = length;
-	if (sn->length > 0)
-		memcpy(sn->pattern, pattern, sn->length*sizeof(u16));
+	sn->fill = 0;
+	sn->rx_count = 0;
+	sn->npatterns = npatterns;
+	if (npatterns > 0)
+		memcpy(sn->patterns, patterns,
+		       npatterns*sizeof(struct uart_snoop_pattern));
+	memset(sn->page, 0, sizeof(struct uart_snoop_page));
 
 	spin_unlock_irqrestore(&port->lock, flags);
 
@@ -814,20 +895,26 @@ static ssize_t parrot5_serial_snoop_pattern_show(struct device *dev,
 {
 	ssize_t count = 0;
 	unsigned long flags;
-	unsigned int i, length;
-	u16 pattern[UART_SNOOP_PATTERN_MAX_LEN];
+	unsigned int i, j, npatterns;
+	struct uart_snoop_pattern patterns[UART_SNOOP_MAX_PATTERNS];
 	struct uart_port *port = (struct uart_port *)dev_get_drvdata(dev);
 	struct uart_parrot5_port *up = (struct uart_parrot5_port *)port;
 	struct uart_snoop *sn = &up->snoop;
 
 	spin_lock_irqsave(&port->lock, flags);
-	length = sn->length;
-	if (length > 0)
-		memcpy(pattern, sn->pattern, length*sizeof(u16));
+	npatterns = sn->npatterns;
+	if (npatterns > 0)
+		memcpy(patterns, sn->patterns,
+		       npatterns*sizeof(struct uart_snoop_pattern));
 	spin_unlock_irqrestore(&port->lock, flags);
 
-	for (i = 0; i < length; i++)
-		count += scnprintf(&buf[count], 5, "%04x", pattern[i]);
+	for (i = 0; i < npatterns; i++) {
+		if (i > 0)
+			count += scnprintf(&buf[count], 2, " ");
+		for (j = 0; j < patterns[i].length; j++)
+			count += scnprintf(&buf[count], 5, "%04x",
+					   patterns[i].pattern[j]);
+	}
 
 	return count;
 }
@@ -837,6 +924,28 @@ static DEVICE_ATTR(snoop_pattern,
 		   parrot5_serial_snoop_pattern_show,
 		   parrot5_serial_snoop_pattern_store);
 
+static ssize_t parrot5_serial_snoop_event_show(struct device *dev,
+					       struct device_attribute *attr,
+					       char *buf)
+{
+	u32 version;
+	unsigned long flags;
+	struct uart_port *port = (struct uart_port *)dev_get_drvdata(dev);
+	struct uart_parrot5_port *up = (struct uart_parrot5_port *)port;
+	struct uart_snoop *sn = &up->snoop;
+
+	spin_lock_irqsave(&port->lock, flags);
+	version = sn->version;
+	spin_unlock_irqrestore(&port->lock, flags);
+
+	return sprintf(buf, "%u\n", version);
+}
+
+static DEVICE_ATTR(snoop_event,
+		   S_IRUGO,
+		   parrot5_serial_snoop_event_show,
+		   NULL);
+
 static ssize_t parrot5_serial_snoop_match_read(struct file *filp,
 					       struct kobject *kobj,
 					       struct bin_attribute *attr,
@@ -860,7 +969,7 @@ static ssize_t parrot5_serial_snoop_match_read(struct file *filp,
 		count = PAGE_SIZE-off;
 
 	spin_lock_irqsave(&port->lock, flags);
-	memcpy(buf, sn->page + off, count);
+	memcpy(buf, (u8 *)sn->page + off, count);
 	spin_unlock_irqrestore(&port->lock, flags);
 
 	return count;
@@ -897,52 +1006,87 @@ static struct bin_attribute snoop_match = {
 #define POS(_p)								\
 	(((_p) + UART_SNOOP_PATTERN_MAX_LEN) & (UART_SNOOP_PATTERN_MAX_LEN-1))
 
-static inline int match_byte(const struct uart_snoop *sn, unsigned int n)
+static inline int match_byte(const struct uart_snoop *sn,
+			     const struct uart_snoop_pattern *sp,
+			     unsigned int n)
 {
 	u16 pat;
 	unsigned int pos;
 
-	pat = sn->pattern[n];
-	pos = POS(sn->pos + n - sn->length);
+	pat = sp->pattern[n];
+	pos = POS(sn->pos + n - sp->length);
 
 	return (sn->buffer[pos] & (pat >> 8)) == (pat & 0xff);
 }
 
+static int match_pattern(const struct uart_snoop *sn,
+			 const struct uart_snoop_pattern *sp)
+{
+	unsigned int i;
+
+	/* not enough bytes received yet */
+	if (sn->fill < sp->length)
+		return 0;
+
+	/* fast check: verify first and last discriminant bytes */
+	if (!match_byte(sn, sp, sp->filter_first) ||
+	    !match_byte(sn, sp, sp->filter_last))
+		return 0;
+
+	/* slow check: verify rest of pattern */
+	for (i = sp->filter_first+1; i < sp->filter_last; i++)
+		if (!match_byte(sn, sp, i))
+			return 0;
+
+	return 1;
+}
 
 /* port locked, interrupts locally disabled */
 static void parrot5_serial_snoop_match(struct uart_port *port, unsigned char c)
 {
-	unsigned int i, pos;
+	unsigned int i, j, pos, matched = 0;
 	struct uart_parrot5_port *up = (struct uart_parrot5_port *)port;
 	struct uart_snoop *sn = &up->snoop;
+	struct uart_snoop_pattern *sp;
+	struct uart_snoop_match *m;
 
-	if (!sn->length)
+	if (!sn->npatterns)
 		return;
 
 	/* first, store current byte */
 	sn->buffer[sn->pos++] = c;
 	sn->pos = POS(sn->pos);
+	sn->rx_count++;
+	if (sn->fill < UART_SNOOP_PATTERN_MAX_LEN)
+		sn->fill++;
+
+	for (i = 0; i < sn->npatterns; i++) {
+		sp = &sn->patterns[i];
+		if (!match_pattern(sn, sp))
+			continue;
+
+		/* match! */
+		m = &sn->page->match[i];
+		pos = POS(sn->pos - sp->length);
+		for (j = 0; j < sp->length; j++)
+			m->data[j] = sn->buffer[POS(pos+j)];
+		m->count++;
+		m->offset = sn->rx_count - sp->length;
+
+		memcpy(sn->page->data, m->data, sp->length);
+		sn->page->index = i;
+		matched = 1;
+	}
 
-	/* fast check: verify first and last discriminant bytes */
-	if (!match_byte(sn, sn->filter_first) ||
-	    !match_byte(sn, sn->filter_last))
-		/* mismatch */
+	if (!matched)
 		return;
 
-	/* slow check: verify rest of pattern */
-	for (i = sn->filter_first+1; i < sn->filter_last; i++)
-		if (!match_byte(sn, i))
-			/* mismatch */
-			return;
-
-	/* match! */
-	/* if not enough bytes have been seen, we may have a false positive */
 	sn->version++;
-	memcpy(sn->page, &sn->version, sizeof(sn->version));
-	pos = POS(sn->pos - sn->length);
+	sn->page->version = sn->version;
 
-	for (i = 0; i < sn->length; i++)
-		sn->page[sizeof(sn->version)+i] = sn->buffer[POS(pos+i)];
+	/* wake up pollers of attribute 'snoop_event' */
+	if (sn->event)
+		sysfs_notify_dirent(sn->event);
 }
 
 static int parrot5_serial_snoop_probe(struct platform_device *dev)
@@ -951,10 +1095,11 @@ static int parrot5_serial_snoop_probe(struct platform_device *dev)
 	struct uart_parrot5_port *up = platform_get_drvdata(dev);
 	struct uart_snoop *sn = &up->snoop;
 
-	sn->length = 0;
+	sn->npatterns = 0;
+	sn->event = NULL;
 	memset(sn->buffer, 0, sizeof(sn->buffer));
 
-	sn->page = (u8 *)get_zeroed_page(GFP_KERNEL);
+	sn->page = (struct uart_snoop_page *)get_zeroed_page(GFP_KERNEL);
 	if (sn->page == NULL) {
 		dev_err(&dev->dev, "failed to allocate data page\n");
 		ret = -ENOMEM;
@@ -973,8 +1118,25 @@ static int parrot5_serial_snoop_probe(struct platform_device *dev)
 		goto nobinattr;
 	}
 
+	ret = device_create_file(&dev->dev, &dev_attr_snoop_event);
+	if (ret < 0) {
+		dev_err(&dev->dev, "failed to create event attribute\n");
+		goto noevent;
+	}
+
+	sn->event = sysfs_get_dirent(dev->dev.kobj.sd, NULL, "snoop_event");
+	if (sn->event == NULL) {
+		dev_err(&dev->dev, "failed to get event attribute\n");
+		ret = -ENODEV;
+		goto nodirent;
+	}
+
 	return 0;
 
+nodirent:
+	device_remove_file(&dev->dev, &dev_attr_snoop_event);
+noevent:
+	device_remove_bin_file(&dev->dev, &snoop_match);
 nobinattr:
 	device_remove_file(&dev->dev, &dev_attr_snoop_pattern);
 noattr:
@@ -985,9 +1147,19 @@ nopage:
 
 static void parrot5_serial_snoop_remove(struct platform_device *dev)
 {
+	unsigned long flags;
+	struct sysfs_dirent *event;
 	struct uart_parrot5_port *up = platform_get_drvdata(dev);
 	struct uart_snoop *sn = &up->snoop;
 
+	spin_lock_irqsave(&up->port.lock, flags);
+	event = sn->event;
+	sn->event = NULL;
+	sn->npatterns = 0;
+	spin_unlock_irqrestore(&up->port.lock, flags);
+
+	sysfs_put(event);
+	device_remove_file(&dev->dev, &dev_attr_snoop_event);
 	device_remove_file(&dev->dev, &dev_attr_snoop_pattern);
 	device_remove_bin_file(&dev->dev, &snoop_match);
 	free_page((unsigned long)sn->page);
@@ -219,6 +219,9 @@ struct card_data_t
     int32_t             pcms_cnt;
     aai_device_t        *chans;
     uint32_t            deven;
+    uint32_t            srconv_chans; /*!< channels routed through SRConv */
+    int                 srconv_rate;  /*!< SRConv rate of those channels (Hz) */
+    int                 srconv_out_saved; /*!< SRConv taken from the outputs */
     int                 irq;
     int                 fiq;
 
@@ -322,6 +322,13 @@ AC_CLKM and AC_SYNCM, sample rate converter is unused.
 AC_CLKM and AC_SYNCM, sample rate converter automatically adapt this
 streams for fifos to be synchronous.
 </ul>
+<ul>
+<li>if AAI is master and ich2-music or ich3-music is opened at a rate other
+than 44,1kHz or 48kHz, the stream is routed through the sample rate
+converter at prepare time. Direction is switched to inputs if no output
+uses it. Both inputs share the converter and must then run at the same rate.
+AAI_IOR_SRCONV_PATH returns the devices currently routed through it.
+</ul>
 
 <div align="center">
 <img alt="Sample rate conversion on inputs" src="aai-srconv.png" border="5">
@@ -279,6 +279,23 @@ int aai_hw_set_srconvdir(struct card_data_t *aai, int val)
     return aai->spec_ops->set_srconvdir(aai, val);
 }
 
+/**
+ * @brief Give SRConv back to the outputs.
+ * When inputs borrowed it from the outputs, switch it back once no input is
+ * routed through it anymore, so that the direction set by the srconvdir
+ * ioctl is kept. hwlock must be held.
+ *
+ * @param aai private driver data
+ */
+void aai_hw_srconv_restore(struct card_data_t *aai)
+{
+    if (aai->srconv_out_saved && !aai->srconv_chans)
+    {
+        aai_setbit(aai, AAI_ITEN, AAI_ITEN_SRC_OUT, 1);
+        aai->srconv_out_saved = 0;
+    }
+}
+
 /**
  * Get Sample rate convertor ratio.
  *
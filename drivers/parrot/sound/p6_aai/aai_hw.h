@@ -78,6 +78,7 @@ int  aai_hw_stop_channel(aai_device_t *chan);
 int  aai_hw_set_srconvdir(struct card_data_t *aai, int val);
 int  aai_hw_set_srconvrate(struct card_data_t *aai, int rate);
 int  aai_hw_get_srconvrate(struct card_data_t *aai);
+void aai_hw_srconv_restore(struct card_data_t *aai);
 
 int  aai_hw_setloudref(struct card_data_t *aai, uint32_t outn, int ref);
 
@@ -170,6 +170,7 @@ enum
 #define AAI_IOR_DMACNT_AUX          _IOR('p', 82, int)
 #define AAI_IOR_DMACNT_VOICE        _IOR('p', 83, int)
 #define AAI_IOR_SRCONV_RATE         _IOW('p', 84, int)
+#define AAI_IOR_SRCONV_PATH         _IOR('p', 85, int)
 
 #define AAI_IOWR_READREG            _IOWR('p', 100, int)
 #define AAI_IOWR_SRCONV_RATE        _IOWR('p', 101, int)
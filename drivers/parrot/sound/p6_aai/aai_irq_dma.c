@@ -17,6 +17,8 @@
 #include "aai_hw.h"
 #include "aai_irq_dma.h"
 
+#include <trace/events/parrot.h>
+
 /*#define USE_LTT*/
 #ifdef USE_LTT
 # include <trace/parrot.h>
@@ -343,6 +345,7 @@ void aai_period_elapsed(struct card_data_t *aai, aai_device_t *chan)
             chan->nbper++;
         }
 
+        trace_aai_period(chan->name, chan->ipcm, chan->nbper);
         chan->bytes_count -= chan->period_bytes;
     }
 }
@@ -161,6 +161,8 @@ static int aai_ops_close(struct snd_pcm_substream *substream)
 
     spin_lock(&aai->hwlock);
     aai->deven = DEV_STOP(aai->deven,chan->ipcm);
+    aai->srconv_chans &= ~(1 << chan->ipcm);
+    aai_hw_srconv_restore(aai);
     aai_dbg(aai->dev,"0x%08x: DEVEN STOP\n", aai->deven );
     spin_unlock(&aai->hwlock);
 
@@ -370,26 +372,57 @@ static int aai_ops_free(struct snd_pcm_substream *substream)
     return 0;
 }
 
+/**
+ * Offset of the chunk currently transferred within a fifo buffer.
+ * In DMA mode, read it back from the DMASA register: it is reloaded by the
+ * hardware at the end of each chunk, while pcurrent is only updated once
+ * the FIQ has run.
+ */
+static ssize_t aai_fifo_offset(aai_device_t *chan, aai_hwchan_t *fifo)
+{
+    struct card_data_t *aai = chan->pdrvdata;
+    char *hw;
+
+    if (chan->mode == AAI_DMA_XFER)
+    {
+        hw = (char *)aai_readreg(aai, fifo->dmasa);
+        if (hw >= fifo->pstart && hw <= fifo->pend)
+            return hw - fifo->pstart;
+    }
+
+    return fifo->pcurrent - fifo->pstart;
+}
+
 /**
  * Pointer operator.
  * return the amount of frames used within the audio buffer
+ *
+ * The AAI has no sample counter: the position is the start of the chunk
+ * being transferred. On capture the samples of that chunk are already
+ * recorded, so they are reported as delay. On playback the chunk is still
+ * between hw_ptr and appl_ptr, which snd_pcm_delay() already accounts for.
  */
 static snd_pcm_uframes_t aai_ops_pointer(struct snd_pcm_substream *substream)
 {
     struct snd_pcm_runtime *runtime = substream->runtime;
     aai_device_t * chan = substream2chan(substream);
-    ssize_t bytes;
+    ssize_t bytes, inflight;
 
     if (chan->access == AAI_NONINTERLEAVED)
     {
-        bytes = chan->fifo[0].pcurrent - chan->fifo[0].pstart
-              + chan->fifo[1].pcurrent - chan->fifo[1].pstart;
+        bytes = aai_fifo_offset(chan, &chan->fifo[0])
+              + aai_fifo_offset(chan, &chan->fifo[1]);
+        inflight = 2*chan->dmaxfersz;
     }
     else
     {
-        bytes = chan->fifo[0].pcurrent - chan->fifo[0].pstart;
+        bytes = aai_fifo_offset(chan, &chan->fifo[0]);
+        inflight = chan->dmaxfersz;
     }
 
+    if (substream->stream == SNDRV_PCM_STREAM_CAPTURE)
+        runtime->delay = bytes_to_frames(runtime, inflight);
+
     return bytes_to_frames(runtime, bytes);
 }
 
@@ -277,6 +277,70 @@ static int aai_hw_set_pcmrate(aai_device_t *chan, int rate)
     return err;
 }
 
+/**
+ * @brief Route a capture channel through the Sample Rate Converter.
+ * ICH2 and ICH3 music inputs can only run at the I2S master rate
+ * (44,1kHz or 48kHz); any other rate is produced by SRConv. Its direction
+ * is switched to inputs when no other device holds it, and given back to
+ * the outputs by aai_hw_srconv_restore() once the last such input is gone.
+ * hwlock must be held.
+ *
+ * @param chan pointer to an audio device descriptor
+ * @param rate numerical value
+ * @param srconvout current SRConv direction
+ *
+ * @retval 0 if succeed
+ * @retval -EBUSY if SRConv is used by another device or at another rate
+ */
+static int aai_hw_route_srconvin(aai_device_t *chan, int rate, int srconvout)
+{
+    struct card_data_t *aai = chan->pdrvdata;
+    uint32_t others = aai->srconv_chans & ~(1 << chan->ipcm);
+    uint32_t native;
+    int err;
+
+    if (srconvout && srconv_is_locked(DEV_STOP(aai->deven, chan->ipcm)))
+    {
+        aai_warn(aai->dev,"%s(%d) - SRConv is used by outputs deven:0x%08x\n",
+                 chan->name, chan->ipcm, aai->deven);
+        return -EBUSY;
+    }
+
+    if (others && (aai->srconv_rate != rate))
+    {
+        aai_warn(aai->dev,"%s(%d) - SRConv already runs at %d Hz\n",
+                 chan->name, chan->ipcm, aai->srconv_rate);
+        return -EBUSY;
+    }
+
+    /* inputs share the converter: none may be running at the native rate */
+    native = DEV_STOP(aai->deven, chan->ipcm) & DEV_SRCONV_IN_ON & ~others;
+    if (native)
+    {
+        aai_warn(aai->dev,"%s(%d) - inputs run at the I2S rate deven:0x%08x\n",
+                 chan->name, chan->ipcm, aai->deven);
+        return -EBUSY;
+    }
+
+    err = aai_hw_set_srconvrate(aai, rate*SRCONV_PRECISION);
+    if (err != 0)
+        return err;
+
+    if (srconvout)
+    {
+        aai_setbit(aai, AAI_ITEN, AAI_ITEN_SRC_OUT, 0);
+        aai->srconv_out_saved = 1;
+    }
+
+    if (!(aai->srconv_chans & (1 << chan->ipcm)))
+        aai_print(aai->dev,"%s(%d) - capture at %d Hz through SRConv\n",
+                  chan->name, chan->ipcm, rate);
+    aai->srconv_chans |= (1 << chan->ipcm);
+    aai->srconv_rate = rate;
+
+    return 0;
+}
+
 #define SRCONVOUTLOCKEDCHANS(_ipcm_) ((1<<_ipcm_) & ((1<<AAI_MIC0_MUSIC)    \
                                                   | (1<<AAI_MIC2_MUSIC)     \
                                                   | (1<<AAI_FBACK_MUSIC)))
@@ -288,14 +352,34 @@ static int aai_hw_set_channelrate(aai_device_t *chan, int rate)
     struct card_data_t *aai = chan->pdrvdata;
 
     spin_lock(&aai->hwlock);
+    aai->srconv_chans &= ~(1 << chan->ipcm);
+    aai_hw_srconv_restore(aai);
     srconvout = aai_readreg(aai,AAI_ITEN) & AAI_ITEN_SRC_OUT ? 1 : 0;
     i2smaster = aai_readreg(aai,AAI_CFG) & AAI_CFG_AAI_SLAVE ? 0 : 1;
 
+    /*
+     * Capture at a rate the I2S master can't produce: go through SRConv.
+     */
+    if (DEV_SRCONV_IN(chan->ipcm) && i2smaster &&
+        (rate != 44100) && (rate != 48000))
+    {
+        err = aai_hw_route_srconvin(chan, rate, srconvout);
+    }
+    /*
+     * The other inputs are resampled: this one can't run at the I2S rate.
+     */
+    else if (DEV_SRCONV_IN(chan->ipcm) && i2smaster &&
+             (aai->srconv_chans & DEV_SRCONV_IN_ON))
+    {
+        aai_warn(aai->dev,"%s(%d) - SRConv inputs run at %d Hz\n",
+                 chan->name, chan->ipcm, aai->srconv_rate);
+        err = -EBUSY;
+    }
     /*
      * BUG:
      * When SRConv is applied on ouputs, ICH0, ICH2 and ICH3 are disabled.
      */
-    if (srconvout && (SRCONVOUTLOCKEDCHANS(chan->ipcm))!= 0)
+    else if (srconvout && (SRCONVOUTLOCKEDCHANS(chan->ipcm))!= 0)
     {
         aai_dbg(chan2dev(chan),"%s(%d) - conflicts with SRCONV_OUT\n", chan->name, chan->ipcm);
     }
@@ -304,6 +388,11 @@ static int aai_hw_set_channelrate(aai_device_t *chan, int rate)
         if (DEV_SRCONV_OUT(chan->ipcm) && srconvout && i2smaster)
         {
             err = aai_hw_set_srconvrate(aai, rate*SRCONV_PRECISION);
+            if (err == 0)
+            {
+                aai->srconv_chans |= (1 << chan->ipcm);
+                aai->srconv_rate = rate;
+            }
 
             /*
              * SRConvIn depends on i2s rate. If AAI is slave, input rate is unknown
@@ -129,6 +129,11 @@ int aai_mixer_new_p6i(struct card_data_t *aai);
  *
  * @return boolean (0:disabled / 1:enabled)
  */
+/**
+ * Inputs that go through SRConv when it is switched to inputs.
+ */
+#define DEV_SRCONV_IN_ON (MIC2_MUSIC_ON)
+
 #define DEV_SRCONV_ON   (MIC0_8K_ON    | \
                          MIC0_16K_ON   | \
                          MIC0_MUSIC_ON | \
@@ -125,6 +125,19 @@ static int aai_hwdep_ioctl(struct snd_hwdep *hwdep,
             err = put_data(&val, (void __user *)arg, sizeof(unsigned int));
             break;
 
+        /** <li><b>AAI_IOR_SRCONV_PATH:</b><br>
+         * Get devices currently routed through the sample rate converter<br>
+         * Param  : none(uint)<br>
+         * Return : bit mask of device indexes (1 << ipcm), 0 if every device runs at its native rate(uint)<br>
+         * <hr>
+         */
+        case AAI_IOR_SRCONV_PATH:
+            spin_lock(&aai->hwlock);
+            val = aai->srconv_chans;
+            spin_unlock(&aai->hwlock);
+            err = put_data(&val, (void __user *)arg, sizeof(unsigned int));
+            break;
+
         /** <li><b>AAI_IOWR_SRCONV_RATE:</b><br>
          * Set sample rate converter rate<br>
          * Param  : User rate value with a precision of 0,01Hz(ie 2205010 -> 22050,10Hz.(uint)<br>
@@ -49,6 +49,8 @@
 #include <mach/dma-pl08x.h>
 #include <mach/gpio.h>
 
+#include <trace/events/parrot.h>
+
 /*
  * P6 SPI interface registers
  */
@@ -256,6 +258,8 @@ static void giveback(struct driver_data *drv_data)
 	drv_data->cur_transfer = NULL;
 	msg->state = NULL;
 
+	trace_p6_spi_msg_done(msg, msg->actual_length, msg->status);
+
 	if (msg->complete)
 		msg->complete(msg->context);
 }
@@ -616,10 +620,12 @@ static int handle_spi_xfer(struct driver_data *drv_data)
 		return 0;
 
 	if (drv_data->use_dma && map_dma_buffer(drv_data)) {
+		trace_p6_spi_xfer(msg, transfer, transfer->len, 1);
 		do {
 			ret = handle_spi_xfer_dma(drv_data);
 		} while (map_next_dma_buffer(drv_data));
 	} else {
+		trace_p6_spi_xfer(msg, transfer, transfer->len, 0);
 		ret = handle_spi_xfer_pio(drv_data);
 	}
 
@@ -0,0 +1,19 @@
+/*
+ * Tracepoint definitions for the Parrot drivers
+ *
+ * See include/trace/events/parrot.h. The tracepoints are instantiated
+ * here, in built-in code, so that both the built-in drivers and the
+ * modules (p264, ...) can fire them.
+ */
+
+#include <linux/module.h>
+
+#define CREATE_TRACE_POINTS
+#include <trace/events/parrot.h>
+
+EXPORT_TRACEPOINT_SYMBOL_GPL(p264_job_start);
+EXPORT_TRACEPOINT_SYMBOL_GPL(p264_job_end);
+EXPORT_TRACEPOINT_SYMBOL_GPL(p6_spi_xfer);
+EXPORT_TRACEPOINT_SYMBOL_GPL(p6_spi_msg_done);
+EXPORT_TRACEPOINT_SYMBOL_GPL(aai_period);
+EXPORT_TRACEPOINT_SYMBOL_GPL(pl08x_complete);
@@ -26,6 +26,7 @@
 #include <linux/highmem.h>
 #include <linux/slab.h>
 #include <linux/lzo.h>
+#include <linux/math64.h>
 #include <linux/string.h>
 #include <linux/vmalloc.h>
 
@@ -37,6 +38,7 @@ static struct zram *devices;
 
 /* Module params (documentation at end) */
 static unsigned int num_devices;
+static unsigned long memlimit_kb;
 
 static int zram_test_flag(struct zram *zram, u32 index,
 			enum zram_pageflags flag)
@@ -339,6 +341,16 @@ static int zram_write(struct zram *zram, struct bio *bio)
 			goto out;
 		}
 
+		if (unlikely(zram->memlimit && zram->stats.compr_size +
+			(clen > max_zpage_size ? PAGE_SIZE : clen) >
+						zram->memlimit)) {
+			mutex_unlock(&zram->lock);
+			pr_debug("Memory limit reached: %zu kB\n",
+				zram->memlimit >> 10);
+			zram_stat64_inc(zram, &zram->stats.failed_writes);
+			goto out;
+		}
+
 		/*
 		 * Page is incompressible. Store it as-is (uncompressed)
 		 * since we do not want to return too many disk write
@@ -504,6 +516,7 @@ static void reset_device(struct zram *zram)
 	memset(&zram->stats, 0, sizeof(zram->stats));
 
 	zram->disksize = 0;
+	zram->memlimit = 0;
 }
 
 static int zram_ioctl_init_device(struct zram *zram)
@@ -517,6 +530,8 @@ static int zram_ioctl_init_device(struct zram *zram)
 	}
 
 	zram_set_disksize(zram, totalram_pages << PAGE_SHIFT);
+	if (!zram->memlimit)
+		zram->memlimit = memlimit_kb << 10;
 
 	zram->compress_workmem = kzalloc(LZO1X_MEM_COMPRESS, GFP_KERNEL);
 	if (!zram->compress_workmem) {
@@ -579,7 +594,7 @@ static int zram_ioctl(struct block_device *bdev, fmode_t mode,
 			unsigned int cmd, unsigned long arg)
 {
 	int ret = 0;
-	size_t disksize_kb;
+	size_t disksize_kb, memlimit_kb;
 
 	struct zram *zram = bdev->bd_disk->private_data;
 
@@ -598,6 +613,16 @@ static int zram_ioctl(struct block_device *bdev, fmode_t mode,
 		pr_info("Disk size set to %zu kB\n", disksize_kb);
 		break;
 
+	case ZRAMIO_SET_MEMLIMIT_KB:
+		if (copy_from_user(&memlimit_kb, (void *)arg,
+						_IOC_SIZE(cmd))) {
+			ret = -EFAULT;
+			goto out;
+		}
+		zram->memlimit = memlimit_kb << 10;
+		pr_info("Memory limit set to %zu kB\n", memlimit_kb);
+		break;
+
 	case ZRAMIO_GET_STATS:
 	{
 		struct zram_ioctl_stats *stats;
@@ -661,6 +686,115 @@ static const struct block_device_operations zram_devops = {
 	.owner = THIS_MODULE
 };
 
+static struct zram *dev_to_zram(struct device *dev)
+{
+	return dev_to_disk(dev)->private_data;
+}
+
+static ssize_t memlimit_kb_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct zram *zram = dev_to_zram(dev);
+
+	return sprintf(buf, "%zu\n", zram->memlimit >> 10);
+}
+
+static ssize_t memlimit_kb_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t len)
+{
+	struct zram *zram = dev_to_zram(dev);
+	unsigned long val;
+
+	if (strict_strtoul(buf, 10, &val))
+		return -EINVAL;
+
+	zram->memlimit = val << 10;
+	return len;
+}
+
+static DEVICE_ATTR(memlimit_kb, S_IRUGO | S_IWUSR,
+		memlimit_kb_show, memlimit_kb_store);
+
+#if defined(CONFIG_ZRAM_STATS)
+static ssize_t orig_data_size_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct zram *zram = dev_to_zram(dev);
+
+	return sprintf(buf, "%llu\n",
+		(u64)zram->stats.pages_stored << PAGE_SHIFT);
+}
+
+static ssize_t compr_data_size_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct zram *zram = dev_to_zram(dev);
+
+	return sprintf(buf, "%llu\n", (u64)zram->stats.compr_size);
+}
+
+static ssize_t mem_used_total_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct zram *zram = dev_to_zram(dev);
+	u64 val = 0;
+
+	if (zram->init_done)
+		val = xv_get_total_size_bytes(zram->mem_pool) +
+			((u64)zram->stats.pages_expand << PAGE_SHIFT);
+
+	return sprintf(buf, "%llu\n", val);
+}
+
+/*
+ * Compressed size in percent of the original size, zero filled
+ * pages excluded: 25 means 4:1.
+ */
+static ssize_t compr_ratio_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct zram *zram = dev_to_zram(dev);
+	u64 orig = (u64)zram->stats.pages_stored << PAGE_SHIFT;
+	u64 compr = (u64)zram->stats.compr_size * 100;
+
+	if (!orig)
+		return sprintf(buf, "0\n");
+
+	return sprintf(buf, "%llu\n", div64_u64(compr, orig));
+}
+
+static ssize_t failed_writes_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct zram *zram = dev_to_zram(dev);
+
+	return sprintf(buf, "%llu\n",
+		zram_stat64_read(zram, &zram->stats.failed_writes));
+}
+
+static DEVICE_ATTR(orig_data_size, S_IRUGO, orig_data_size_show, NULL);
+static DEVICE_ATTR(compr_data_size, S_IRUGO, compr_data_size_show, NULL);
+static DEVICE_ATTR(mem_used_total, S_IRUGO, mem_used_total_show, NULL);
+static DEVICE_ATTR(compr_ratio, S_IRUGO, compr_ratio_show, NULL);
+static DEVICE_ATTR(failed_writes, S_IRUGO, failed_writes_show, NULL);
+#endif /* CONFIG_ZRAM_STATS */
+
+static struct attribute *zram_disk_attrs[] = {
+	&dev_attr_memlimit_kb.attr,
+#if defined(CONFIG_ZRAM_STATS)
+	&dev_attr_orig_data_size.attr,
+	&dev_attr_compr_data_size.attr,
+	&dev_attr_mem_used_total.attr,
+	&dev_attr_compr_ratio.attr,
+	&dev_attr_failed_writes.attr,
+#endif
+	NULL,
+};
+
+static struct attribute_group zram_disk_attr_group = {
+	.attrs = zram_disk_attrs,
+};
+
 static int create_device(struct zram *zram, int device_id)
 {
 	int ret = 0;
@@ -710,6 +844,12 @@ static int create_device(struct zram *zram, int device_id)
 
 	add_disk(zram->disk);
 
+	/* Not fatal: the device remains usable through ioctls */
+	if (sysfs_create_group(&disk_to_dev(zram->disk)->kobj,
+				&zram_disk_attr_group))
+		pr_warning("Error creating sysfs group for device %d\n",
+			device_id);
+
 	zram->init_done = 0;
 
 out:
@@ -719,6 +859,8 @@ out:
 static void destroy_device(struct zram *zram)
 {
 	if (zram->disk) {
+		sysfs_remove_group(&disk_to_dev(zram->disk)->kobj,
+				&zram_disk_attr_group);
 		del_gendisk(zram->disk);
 		put_disk(zram->disk);
 	}
@@ -797,6 +939,9 @@ static void __exit zram_exit(void)
 
 module_param(num_devices, uint, 0);
 MODULE_PARM_DESC(num_devices, "Number of zram devices");
+module_param(memlimit_kb, ulong, 0);
+MODULE_PARM_DESC(memlimit_kb, "Default limit on compressed data per device "
+		"in kB (0: no limit)");
 
 module_init(zram_init);
 module_exit(zram_exit);
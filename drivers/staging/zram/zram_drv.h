@@ -119,6 +119,11 @@ struct zram {
 	 * we can store in a disk.
 	 */
 	size_t disksize;	/* bytes */
+	/*
+	 * Limit on the amount of *compressed* data stored in the disk.
+	 * Writes beyond it fail. 0 means no limit.
+	 */
+	size_t memlimit;	/* bytes */
 
 	struct zram_stats stats;
 };
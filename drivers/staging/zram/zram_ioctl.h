@@ -37,5 +37,6 @@ struct zram_ioctl_stats {
 #define ZRAMIO_GET_STATS	_IOR('z', 1, struct zram_ioctl_stats)
 #define ZRAMIO_INIT		_IO('z', 2)
 #define ZRAMIO_RESET		_IO('z', 3)
+#define ZRAMIO_SET_MEMLIMIT_KB	_IOW('z', 4, size_t)
 
 #endif
@@ -22,10 +22,13 @@
 #include <linux/platform_device.h>
 #include <linux/io.h>
 #include <linux/clk.h>
+#include <linux/log2.h>
 #include <mach/usb-p6i.h>
 
 #include "ehci-p6i.h"
 
+static struct attribute_group p6p_tuning_attr_group;
+
 /* FIXME: Power Management is un-ported so temporarily disable it */
 #undef CONFIG_PM
 
@@ -131,6 +134,10 @@ int usb_hcd_p6p_probe(const struct hc_driver *driver,
 	retval = usb_add_hcd(hcd, irq, IRQF_DISABLED | IRQF_SHARED);
 	if (retval != 0)
 		goto err4;
+
+	if (sysfs_create_group(&pdev->dev.kobj, &p6p_tuning_attr_group))
+		dev_warn(&pdev->dev, "cannot create tuning attributes\n");
+
 	return retval;
 
       err4:
@@ -157,6 +164,7 @@ int usb_hcd_p6p_probe(const struct hc_driver *driver,
  */
 void usb_hcd_p6p_remove(struct usb_hcd *hcd, struct platform_device *pdev)
 {
+	sysfs_remove_group(&pdev->dev.kobj, &p6p_tuning_attr_group);
 	usb_remove_hcd(hcd);
 	iounmap(hcd->regs);
 	release_mem_region(hcd->rsrc_start, hcd->rsrc_len);
@@ -192,6 +200,38 @@ static void p6p_setup_portsc(struct ehci_hcd *ehci,
 	ehci_writel(ehci, portsc, &ehci->regs->port_status[port_offset]);
 }
 
+/* AHB burst and TX FIFO settings, lost on controller reset */
+static void p6p_setup_bus(struct usb_hcd *hcd,
+			  struct p6i_usb2_platform_data_s *pdata)
+{
+	u32 temp;
+
+	if (pdata->ahb_burst) {
+		temp = readl(hcd->regs + P6P_SOC_USB_SBUSCFG);
+		temp &= ~SBUSCFG_AHBBRST_MSK;
+		temp |= pdata->ahb_burst - 1;
+		writel(temp, hcd->regs + P6P_SOC_USB_SBUSCFG);
+	}
+
+	if (pdata->rx_burst || pdata->tx_burst) {
+		temp = readl(hcd->regs + P6P_SOC_USB_BURSTSIZE);
+		if (pdata->rx_burst)
+			temp = (temp & ~BURSTSIZE_RX(0xff)) |
+				BURSTSIZE_RX(pdata->rx_burst);
+		if (pdata->tx_burst)
+			temp = (temp & ~BURSTSIZE_TX(0xff)) |
+				BURSTSIZE_TX(pdata->tx_burst);
+		writel(temp, hcd->regs + P6P_SOC_USB_BURSTSIZE);
+	}
+
+	if (pdata->tx_fifo_thres) {
+		temp = readl(hcd->regs + P6P_SOC_USB_TXFILLTUNING);
+		temp &= ~TXFILLTUNING_FIFOTHRES_MSK;
+		temp |= TXFILLTUNING_FIFOTHRES(pdata->tx_fifo_thres);
+		writel(temp, hcd->regs + P6P_SOC_USB_TXFILLTUNING);
+	}
+}
+
 static void p6p_usb_setup(struct usb_hcd *hcd)
 {
 	struct ehci_hcd *ehci = hcd_to_ehci(hcd);
@@ -203,8 +243,81 @@ static void p6p_usb_setup(struct usb_hcd *hcd)
            (pdata->operating_mode == P6P_USB2_DR_OTG))
 		p6p_setup_portsc(ehci, pdata->phy_mode,
 				 pdata->force_full_speed, 0);
+
+	p6p_setup_bus(hcd, pdata);
 }
 
+/*
+ * Runtime tuning: /sys/devices/platform/p6i-ehci.0/{irq_thresh,ahb_burst,
+ * tx_burst,rx_burst,tx_fifo_thres}, same units as platform data.
+ */
+static ssize_t p6p_store_tuning(struct device *dev, const char *buf,
+				size_t count, unsigned int *field,
+				unsigned long max)
+{
+	struct usb_hcd *hcd = dev_get_drvdata(dev);
+	struct ehci_hcd *ehci = hcd_to_ehci(hcd);
+	struct p6i_usb2_platform_data_s *pdata = dev->platform_data;
+	unsigned long val;
+	u32 cmd;
+
+	if (strict_strtoul(buf, 0, &val) || val == 0 || val > max)
+		return -EINVAL;
+	if (field == &pdata->irq_thresh && !is_power_of_2(val))
+		return -EINVAL;
+
+	spin_lock_irq(&ehci->lock);
+	*field = val;
+	if (field == &pdata->irq_thresh) {
+		cmd = ehci_readl(ehci, &ehci->regs->command);
+		cmd = (cmd & ~(0xff << 16)) | (val << 16);
+		ehci_writel(ehci, cmd, &ehci->regs->command);
+		ehci->command = (ehci->command & ~(0xff << 16)) | (val << 16);
+	} else {
+		p6p_setup_bus(hcd, pdata);
+	}
+	spin_unlock_irq(&ehci->lock);
+
+	return count;
+}
+
+#define P6P_TUNING_ATTR(_field, _max)					\
+static ssize_t show_##_field(struct device *dev,			\
+			     struct device_attribute *attr, char *buf)	\
+{									\
+	struct p6i_usb2_platform_data_s *pdata = dev->platform_data;	\
+									\
+	return sprintf(buf, "%u\n", pdata->_field);			\
+}									\
+static ssize_t store_##_field(struct device *dev,			\
+			      struct device_attribute *attr,		\
+			      const char *buf, size_t count)		\
+{									\
+	struct p6i_usb2_platform_data_s *pdata = dev->platform_data;	\
+									\
+	return p6p_store_tuning(dev, buf, count, &pdata->_field, _max);\
+}									\
+static DEVICE_ATTR(_field, S_IRUGO | S_IWUSR, show_##_field, store_##_field)
+
+P6P_TUNING_ATTR(irq_thresh, 64);
+P6P_TUNING_ATTR(ahb_burst, P6P_USB2_AHB_INCR16);
+P6P_TUNING_ATTR(tx_burst, 0xff);
+P6P_TUNING_ATTR(rx_burst, 0xff);
+P6P_TUNING_ATTR(tx_fifo_thres, 0x3f);
+
+static struct attribute *p6p_tuning_attrs[] = {
+	&dev_attr_irq_thresh.attr,
+	&dev_attr_ahb_burst.attr,
+	&dev_attr_tx_burst.attr,
+	&dev_attr_rx_burst.attr,
+	&dev_attr_tx_fifo_thres.attr,
+	NULL,
+};
+
+static struct attribute_group p6p_tuning_attr_group = {
+	.attrs = p6p_tuning_attrs,
+};
+
 /* called after powerup, by probe or system-pm "wakeup" */
 static int ehci_p6p_reinit(struct ehci_hcd *ehci)
 {
@@ -218,6 +331,7 @@ static int ehci_p6p_reinit(struct ehci_hcd *ehci)
 static int ehci_p6p_setup(struct usb_hcd *hcd)
 {
 	struct ehci_hcd *ehci = hcd_to_ehci(hcd);
+	struct p6i_usb2_platform_data_s *pdata;
 	int retval;
 
 	/* EHCI registers start at offset 0x100 */
@@ -240,6 +354,11 @@ static int ehci_p6p_setup(struct usb_hcd *hcd)
 	if (retval)
 		return retval;
 
+	/* interrupt threshold, written to USBCMD by ehci_run() */
+	pdata = hcd->self.controller->platform_data;
+	if (pdata->irq_thresh)
+		ehci->command = (ehci->command & ~(0xff << 16)) |
+				(pdata->irq_thresh << 16);
 
 	ehci->sbrn = 0x20;
 
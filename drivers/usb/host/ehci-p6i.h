@@ -20,6 +20,14 @@
 #define _EHCI_P6P_H
 
 /* offsets for the non-ehci registers in the P6P SOC USB controller */
+#define P6P_SOC_USB_SBUSCFG	0x090
+#define SBUSCFG_AHBBRST_MSK	(7<<0)
+#define P6P_SOC_USB_BURSTSIZE	0x160
+#define BURSTSIZE_RX(x)		((x)<<0)
+#define BURSTSIZE_TX(x)		((x)<<8)
+#define P6P_SOC_USB_TXFILLTUNING	0x164
+#define TXFILLTUNING_FIFOTHRES_MSK	(0x3f<<16)
+#define TXFILLTUNING_FIFOTHRES(x)	((x)<<16)
 #define P6P_SOC_USB_ULPIVP	0x170
 #define P6P_SOC_USB_PORTSC1	0x184
 #define PORT_PTS_MSK		(3<<30)
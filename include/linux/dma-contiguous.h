@@ -0,0 +1,49 @@
+#ifndef __LINUX_DMA_CONTIGUOUS_H
+#define __LINUX_DMA_CONTIGUOUS_H
+
+/*
+ * Contiguous Memory Allocator for DMA buffers
+ *
+ * A region is reserved at boot with dma_contiguous_reserve(). Until a
+ * driver needs it, the page allocator lends it to movable allocations
+ * (page cache, anonymous memory). dma_alloc_from_contiguous() migrates
+ * the borrowed pages away and returns a physically contiguous buffer.
+ */
+
+#ifdef __KERNEL__
+
+struct device;
+struct page;
+
+#ifdef CONFIG_CMA
+
+extern void dma_contiguous_reserve(void);
+
+struct page *dma_alloc_from_contiguous(struct device *dev, int count,
+				       unsigned int order);
+int dma_release_from_contiguous(struct device *dev, struct page *pages,
+				int count);
+
+#else
+
+static inline void dma_contiguous_reserve(void) { }
+
+static inline
+struct page *dma_alloc_from_contiguous(struct device *dev, int count,
+				       unsigned int order)
+{
+	return NULL;
+}
+
+static inline
+int dma_release_from_contiguous(struct device *dev, struct page *pages,
+				int count)
+{
+	return 0;
+}
+
+#endif
+
+#endif
+
+#endif
@@ -342,4 +342,14 @@ extern gfp_t gfp_allowed_mask;
 extern void set_gfp_allowed_mask(gfp_t mask);
 extern gfp_t clear_gfp_allowed_mask(gfp_t mask);
 
+#ifdef CONFIG_CMA
+/* The below functions must be run on a range from a single zone. */
+extern int alloc_contig_range(unsigned long start, unsigned long end,
+			      unsigned migratetype);
+extern void free_contig_range(unsigned long pfn, unsigned nr_pages);
+
+/* CMA stuff */
+extern void init_cma_reserved_pageblock(struct page *page);
+#endif
+
 #endif /* __LINUX_GFP_H */
@@ -38,15 +38,50 @@
 #define SCHED_BATCH		3
 /* SCHED_ISO: reserved but not implemented yet */
 #define SCHED_IDLE		5
+#define SCHED_DEADLINE		6
 /* Can be ORed in to make sure the process is reverted back to SCHED_NORMAL on fork */
 #define SCHED_RESET_ON_FORK     0x40000000
 
+/*
+ * sched_attr flags
+ */
+#define SCHED_FLAG_RESET_ON_FORK	0x01
+#define SCHED_FLAG_DL_OVERRUN		0x04	/* SIGXCPU on runtime overrun */
+
 #ifdef __KERNEL__
 
 struct sched_param {
 	int sched_priority;
 };
 
+/*
+ * Extended scheduling parameters, used by sched_setattr()/sched_getattr().
+ *
+ * For SCHED_DEADLINE, the task gets sched_runtime nanoseconds of CPU
+ * time within sched_deadline nanoseconds of the start of every
+ * sched_period. All three must satisfy runtime <= deadline <= period;
+ * a zero period means period == deadline.
+ */
+#define SCHED_ATTR_SIZE_VER0	48	/* sizeof first published struct */
+
+struct sched_attr {
+	u32 size;
+
+	u32 sched_policy;
+	u64 sched_flags;
+
+	/* SCHED_NORMAL, SCHED_BATCH */
+	s32 sched_nice;
+
+	/* SCHED_FIFO, SCHED_RR */
+	u32 sched_priority;
+
+	/* SCHED_DEADLINE */
+	u64 sched_runtime;
+	u64 sched_deadline;
+	u64 sched_period;
+};
+
 #include <asm/param.h>	/* for HZ */
 
 #include <linux/capability.h>
@@ -1026,6 +1061,7 @@ struct sched_domain;
 #define ENQUEUE_WAKEUP		1
 #define ENQUEUE_WAKING		2
 #define ENQUEUE_HEAD		4
+#define ENQUEUE_REPLENISH	8
 
 #define DEQUEUE_SLEEP		1
 
@@ -1071,6 +1107,8 @@ struct sched_class {
 	unsigned int (*get_rr_interval) (struct rq *rq,
 					 struct task_struct *task);
 
+	void (*task_dead) (struct task_struct *p);
+
 #ifdef CONFIG_FAIR_GROUP_SCHED
 	void (*moved_group) (struct task_struct *p, int on_rq);
 #endif
@@ -1158,6 +1196,41 @@ struct sched_rt_entity {
 #endif
 };
 
+struct sched_dl_entity {
+	struct rb_node	rb_node;
+
+	/*
+	 * Reservation parameters, set by sched_setattr(), in nanoseconds.
+	 * dl_bw is dl_runtime / dl_period, scaled by 2^20.
+	 */
+	u64 dl_runtime;
+	u64 dl_deadline;
+	u64 dl_period;
+	u64 dl_bw;
+	unsigned int flags;
+
+	/*
+	 * Current instance: remaining budget and absolute deadline,
+	 * on the rq clock.
+	 */
+	s64 runtime;
+	u64 deadline;
+
+	/*
+	 * @dl_new: no instance started yet, deadline and runtime must be
+	 * set up on the next enqueue.
+	 * @dl_throttled: budget exhausted, off the dl_rq until dl_timer
+	 * replenishes it at the next period.
+	 * @dl_yielded: sched_yield() ended the current instance early.
+	 * @dl_overrun: SIGXCPU pending for a budget overrun.
+	 */
+	int dl_new, dl_throttled, dl_yielded, dl_overrun;
+
+	struct hrtimer dl_timer;
+
+	unsigned long nr_overruns;
+};
+
 struct rcu_node;
 
 struct task_struct {
@@ -1180,6 +1253,7 @@ struct task_struct {
 	const struct sched_class *sched_class;
 	struct sched_entity se;
 	struct sched_rt_entity rt;
+	struct sched_dl_entity dl;
 
 #ifdef CONFIG_PREEMPT_NOTIFIERS
 	/* list of struct preempt_notifier: */
@@ -1921,6 +1995,7 @@ extern int idle_cpu(int cpu);
 extern int sched_setscheduler(struct task_struct *, int, struct sched_param *);
 extern int sched_setscheduler_nocheck(struct task_struct *, int,
 				      struct sched_param *);
+extern int sched_setattr(struct task_struct *, const struct sched_attr *);
 extern struct task_struct *idle_task(int cpu);
 extern struct task_struct *curr_task(int cpu);
 extern void set_curr_task(int cpu, struct task_struct *p);
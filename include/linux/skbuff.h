@@ -170,6 +170,8 @@ struct skb_shared_hwtstamps {
  * @in_progress:	device driver is going to provide
  *			hardware time stamp
  * @prevent_sk_orphan:	make sk reference available on driver level
+ * @dev_zerocopy:	frags are owned by the sender, destructor_arg
+ *			is a &struct ubuf_info
  * @flags:		all shared_tx flags
  *
  * These flags are attached to packets as part of the
@@ -180,11 +182,26 @@ union skb_shared_tx {
 		__u8	hardware:1,
 			software:1,
 			in_progress:1,
-			prevent_sk_orphan:1;
+			prevent_sk_orphan:1,
+			dev_zerocopy:1;
 	};
 	__u8 flags;
 };
 
+/**
+ * struct ubuf_info - completion of a zero copy transmit
+ * @callback:	called when no skb data area refers to the frags anymore
+ * @refcnt:	number of skb data areas referring to the frags
+ *
+ * The sender owns the frag pages and must not reuse them before
+ * @callback runs. Attached to &skb_shared_info.destructor_arg with
+ * &skb_shared_tx.dev_zerocopy set.
+ */
+struct ubuf_info {
+	void (*callback)(struct ubuf_info *);
+	atomic_t refcnt;
+};
+
 /* This data is invariant across clones and lives at
  * the end of the header data, ie. at skb->end.
  */
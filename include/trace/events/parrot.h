@@ -0,0 +1,156 @@
+#undef TRACE_SYSTEM
+#define TRACE_SYSTEM parrot
+
+#if !defined(_TRACE_PARROT_H) || defined(TRACE_HEADER_MULTI_READ)
+#define _TRACE_PARROT_H
+
+#include <linux/types.h>
+#include <linux/tracepoint.h>
+
+/*
+ * Static tracepoints on the Parrot media and bus driver hot paths.
+ *
+ * Records are timestamped by the ftrace ring buffer; when the events are
+ * disabled each call site costs a single test of the tracepoint state.
+ * Enable them with:
+ *   echo 1 > /sys/kernel/debug/tracing/events/parrot/enable
+ */
+
+TRACE_EVENT(p264_job_start,
+
+	TP_PROTO(unsigned int i_mb, unsigned int j_mb, unsigned int nb_mb,
+		 unsigned int nb_mb_to_encode),
+
+	TP_ARGS(i_mb, j_mb, nb_mb, nb_mb_to_encode),
+
+	TP_STRUCT__entry(
+		__field(	unsigned int,	i_mb		)
+		__field(	unsigned int,	j_mb		)
+		__field(	unsigned int,	nb_mb		)
+		__field(	unsigned int,	nb_mb_to_encode	)
+	),
+
+	TP_fast_assign(
+		__entry->i_mb		= i_mb;
+		__entry->j_mb		= j_mb;
+		__entry->nb_mb		= nb_mb;
+		__entry->nb_mb_to_encode = nb_mb_to_encode;
+	),
+
+	TP_printk("mb=%u,%u count=%u target=%u",
+		  __entry->i_mb, __entry->j_mb, __entry->nb_mb,
+		  __entry->nb_mb_to_encode)
+);
+
+TRACE_EVENT(p264_job_end,
+
+	TP_PROTO(unsigned int nb_mb_encoded),
+
+	TP_ARGS(nb_mb_encoded),
+
+	TP_STRUCT__entry(
+		__field(	unsigned int,	nb_mb_encoded	)
+	),
+
+	TP_fast_assign(
+		__entry->nb_mb_encoded	= nb_mb_encoded;
+	),
+
+	TP_printk("encoded=%u", __entry->nb_mb_encoded)
+);
+
+TRACE_EVENT(p6_spi_xfer,
+
+	TP_PROTO(const void *msg, const void *xfer, unsigned int len, int dma),
+
+	TP_ARGS(msg, xfer, len, dma),
+
+	TP_STRUCT__entry(
+		__field(	const void *,	msg		)
+		__field(	const void *,	xfer		)
+		__field(	unsigned int,	len		)
+		__field(	int,		dma		)
+	),
+
+	TP_fast_assign(
+		__entry->msg		= msg;
+		__entry->xfer		= xfer;
+		__entry->len		= len;
+		__entry->dma		= dma;
+	),
+
+	TP_printk("msg=%p xfer=%p len=%u %s",
+		  __entry->msg, __entry->xfer, __entry->len,
+		  __entry->dma ? "dma" : "pio")
+);
+
+TRACE_EVENT(p6_spi_msg_done,
+
+	TP_PROTO(const void *msg, unsigned int actual_length, int status),
+
+	TP_ARGS(msg, actual_length, status),
+
+	TP_STRUCT__entry(
+		__field(	const void *,	msg		)
+		__field(	unsigned int,	actual_length	)
+		__field(	int,		status		)
+	),
+
+	TP_fast_assign(
+		__entry->msg		= msg;
+		__entry->actual_length	= actual_length;
+		__entry->status		= status;
+	),
+
+	TP_printk("msg=%p len=%u status=%d",
+		  __entry->msg, __entry->actual_length, __entry->status)
+);
+
+TRACE_EVENT(aai_period,
+
+	TP_PROTO(const char *name, int ipcm, unsigned int nbper),
+
+	TP_ARGS(name, ipcm, nbper),
+
+	TP_STRUCT__entry(
+		__string(	name,		name		)
+		__field(	int,		ipcm		)
+		__field(	unsigned int,	nbper		)
+	),
+
+	TP_fast_assign(
+		__assign_str(name, name);
+		__entry->ipcm		= ipcm;
+		__entry->nbper		= nbper;
+	),
+
+	TP_printk("%s pcm=%d period=%u",
+		  __get_str(name), __entry->ipcm, __entry->nbper)
+);
+
+TRACE_EVENT(pl08x_complete,
+
+	TP_PROTO(unsigned int chan, const char *devid, int err),
+
+	TP_ARGS(chan, devid, err),
+
+	TP_STRUCT__entry(
+		__field(	unsigned int,	chan		)
+		__string(	devid,		devid		)
+		__field(	int,		err		)
+	),
+
+	TP_fast_assign(
+		__entry->chan		= chan;
+		__assign_str(devid, devid);
+		__entry->err		= err;
+	),
+
+	TP_printk("dma%u %s%s", __entry->chan, __get_str(devid),
+		  __entry->err ? " error" : "")
+);
+
+#endif /* _TRACE_PARROT_H */
+
+/* This part must be outside protection */
+#include <trace/define_trace.h>
@@ -461,6 +461,12 @@ void proc_sched_show_task(struct task_struct *p, struct seq_file *m)
 	P(se.load.weight);
 	P(policy);
 	P(prio);
+	if (p->policy == SCHED_DEADLINE) {
+		PN(dl.dl_runtime);
+		PN(dl.dl_deadline);
+		PN(dl.dl_period);
+		P(dl.nr_overruns);
+	}
 #undef PN
 #undef __PN
 #undef P
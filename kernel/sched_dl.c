@@ -0,0 +1,640 @@
+/*
+ * Deadline Scheduling Class (SCHED_DEADLINE)
+ *
+ * Earliest Deadline First scheduling of tasks holding a CPU bandwidth
+ * reservation: every dl_period, a task may run for dl_runtime and that
+ * instance has to be finished within dl_deadline of the period start.
+ *
+ * Each task is a Constant Bandwidth Server: the runtime it consumes is
+ * charged to its budget and, once the budget is exhausted, the task is
+ * throttled until its next period, whatever it does. A misbehaving task
+ * therefore cannot steal the bandwidth reserved for the others. With
+ * admission control keeping the total reserved bandwidth below the RT
+ * bandwidth limit (sched_rt_runtime_us / sched_rt_period_us), every
+ * task is guaranteed its runtime before its deadline.
+ *
+ * The class sits above SCHED_FIFO/SCHED_RR, and its runtime is charged
+ * to the RT bandwidth as well: RT and deadline tasks together never go
+ * over the limit, and SCHED_NORMAL tasks keep the rest. Tasks are not
+ * migrated by the class: on SMP they should be bound to a CPU.
+ */
+
+/*
+ * Bandwidths are fixed point fractions of one CPU, scaled by 2^20.
+ */
+#define DL_BW_SHIFT	20
+#define DL_BW_UNIT	(1ULL << DL_BW_SHIFT)
+
+/*
+ * Budgets and deadlines are compared at a 1us-ish granularity, which
+ * keeps the products in dl_entity_overflow() within 64 bits.
+ */
+#define DL_SCALE	10
+
+static DEFINE_RAW_SPINLOCK(dl_bw_lock);
+static u64 dl_total_bw;
+
+static inline struct task_struct *dl_task_of(struct sched_dl_entity *dl_se)
+{
+	return container_of(dl_se, struct task_struct, dl);
+}
+
+static inline struct rq *rq_of_dl_rq(struct dl_rq *dl_rq)
+{
+	return container_of(dl_rq, struct rq, dl);
+}
+
+static inline int on_dl_rq(struct sched_dl_entity *dl_se)
+{
+	return !RB_EMPTY_NODE(&dl_se->rb_node);
+}
+
+static inline int dl_time_before(u64 a, u64 b)
+{
+	return (s64)(a - b) < 0;
+}
+
+static inline int is_leftmost(struct task_struct *p, struct dl_rq *dl_rq)
+{
+	return dl_rq->rb_leftmost == &p->dl.rb_node;
+}
+
+static inline u64 dl_bw_of(u64 period, u64 runtime)
+{
+	if (runtime == RUNTIME_INF)
+		return DL_BW_UNIT;
+
+	return div64_u64(runtime << DL_BW_SHIFT, period);
+}
+
+/*
+ * The reserved bandwidth may not exceed what RT throttling would let
+ * real-time tasks use, so that the rest of the system keeps running.
+ */
+static u64 dl_bw_limit(void)
+{
+	return dl_bw_of(global_rt_period(), global_rt_runtime()) *
+		num_online_cpus();
+}
+
+static void init_dl_rq(struct dl_rq *dl_rq)
+{
+	dl_rq->rb_root = RB_ROOT;
+	dl_rq->rb_leftmost = NULL;
+	dl_rq->dl_nr_running = 0;
+}
+
+/*
+ * Start a new instance: full budget, deadline relative to now.
+ */
+static void setup_new_dl_entity(struct sched_dl_entity *dl_se, u64 now)
+{
+	dl_se->deadline = now + dl_se->dl_deadline;
+	dl_se->runtime = dl_se->dl_runtime;
+	dl_se->dl_new = 0;
+}
+
+/*
+ * Called when the budget has been exhausted and the period it belonged
+ * to is over: push the deadline forward by whole periods, paying back
+ * any overrun from the new budget. If we fell so far behind that the
+ * deadline is already in the past, start over from now.
+ */
+static void replenish_dl_entity(struct sched_dl_entity *dl_se, u64 now)
+{
+	while (dl_se->runtime <= 0) {
+		dl_se->deadline += dl_se->dl_period;
+		dl_se->runtime += dl_se->dl_runtime;
+	}
+
+	if (dl_time_before(dl_se->deadline, now))
+		setup_new_dl_entity(dl_se, now);
+}
+
+/*
+ * CBS wakeup rule: keeping the current (deadline, runtime) pair would
+ * let the task use more than its bandwidth if
+ *
+ *   runtime / (deadline - now) > dl_runtime / dl_period
+ */
+static int dl_entity_overflow(struct sched_dl_entity *dl_se, u64 now)
+{
+	u64 left, right;
+
+	left = (dl_se->dl_period >> DL_SCALE) * (dl_se->runtime >> DL_SCALE);
+	right = ((dl_se->deadline - now) >> DL_SCALE) *
+		(dl_se->dl_runtime >> DL_SCALE);
+
+	return dl_time_before(right, left);
+}
+
+static void update_dl_entity(struct sched_dl_entity *dl_se, u64 now)
+{
+	if (dl_se->dl_new || dl_time_before(dl_se->deadline, now) ||
+	    dl_entity_overflow(dl_se, now))
+		setup_new_dl_entity(dl_se, now);
+}
+
+static void __enqueue_dl_entity(struct dl_rq *dl_rq,
+				struct sched_dl_entity *dl_se)
+{
+	struct rb_node **link = &dl_rq->rb_root.rb_node;
+	struct rb_node *parent = NULL;
+	struct sched_dl_entity *entry;
+	int leftmost = 1;
+
+	while (*link) {
+		parent = *link;
+		entry = rb_entry(parent, struct sched_dl_entity, rb_node);
+		if (dl_time_before(dl_se->deadline, entry->deadline)) {
+			link = &parent->rb_left;
+		} else {
+			link = &parent->rb_right;
+			leftmost = 0;
+		}
+	}
+
+	if (leftmost)
+		dl_rq->rb_leftmost = &dl_se->rb_node;
+
+	rb_link_node(&dl_se->rb_node, parent, link);
+	rb_insert_color(&dl_se->rb_node, &dl_rq->rb_root);
+	dl_rq->dl_nr_running++;
+}
+
+static void __dequeue_dl_entity(struct dl_rq *dl_rq,
+				struct sched_dl_entity *dl_se)
+{
+	if (!on_dl_rq(dl_se))
+		return;
+
+	if (dl_rq->rb_leftmost == &dl_se->rb_node)
+		dl_rq->rb_leftmost = rb_next(&dl_se->rb_node);
+
+	rb_erase(&dl_se->rb_node, &dl_rq->rb_root);
+	RB_CLEAR_NODE(&dl_se->rb_node);
+	dl_rq->dl_nr_running--;
+}
+
+/*
+ * Arm the replenishment timer for the start of the next period. The
+ * rq clock and the hrtimer clock differ, so convert through the current
+ * offset between the two. Returns 0 if that instant is already past.
+ */
+static int start_dl_timer(struct rq *rq, struct sched_dl_entity *dl_se)
+{
+	struct hrtimer *timer = &dl_se->dl_timer;
+	ktime_t now, act;
+	s64 delta;
+
+	act = ns_to_ktime(dl_se->deadline - dl_se->dl_deadline +
+			  dl_se->dl_period);
+	now = hrtimer_cb_get_time(timer);
+	delta = ktime_to_ns(now) - rq->clock;
+	act = ktime_add_ns(act, delta);
+
+	if (ktime_us_delta(act, now) <= 0)
+		return 0;
+
+	/*
+	 * We hold rq->lock: do not let hrtimer_start() wake up softirqd
+	 * if the timer turns out to be already expired.
+	 */
+	__hrtimer_start_range_ns(timer, act, 0, HRTIMER_MODE_ABS, 0);
+
+	return hrtimer_active(timer);
+}
+
+static void enqueue_task_dl(struct rq *rq, struct task_struct *p, int flags);
+static void check_preempt_curr_dl(struct rq *rq, struct task_struct *p,
+				  int flags);
+
+/*
+ * Replenishment timer: the throttled task gets its new budget and goes
+ * back on the dl_rq, possibly preempting the running task.
+ *
+ * Runs from hardirq context.
+ */
+static enum hrtimer_restart dl_task_timer(struct hrtimer *timer)
+{
+	struct sched_dl_entity *dl_se = container_of(timer,
+						     struct sched_dl_entity,
+						     dl_timer);
+	struct task_struct *p = dl_task_of(dl_se);
+	unsigned long flags;
+	int overrun = 0;
+	struct rq *rq;
+
+	rq = task_rq_lock(p, &flags);
+
+	/*
+	 * The task may have left SCHED_DEADLINE, or got new parameters,
+	 * while the timer was pending.
+	 */
+	if (!task_has_dl_policy(p) || !dl_se->dl_throttled)
+		goto unlock;
+
+	dl_se->dl_throttled = 0;
+	update_rq_clock(rq);
+	if (p->se.on_rq) {
+		enqueue_task_dl(rq, p, ENQUEUE_REPLENISH);
+		check_preempt_curr_dl(rq, p, 0);
+	} else {
+		/* blocked meanwhile, the wakeup will check the new budget */
+		replenish_dl_entity(dl_se, rq->clock);
+	}
+
+	overrun = dl_se->dl_overrun;
+	dl_se->dl_overrun = 0;
+unlock:
+	task_rq_unlock(rq, &flags);
+
+	/* can't signal with rq->lock held, the wakeup would need it */
+	if (overrun)
+		send_sig(SIGXCPU, p, 1);
+
+	return HRTIMER_NORESTART;
+}
+
+static void init_dl_task_timer(struct sched_dl_entity *dl_se)
+{
+	hrtimer_init(&dl_se->dl_timer, CLOCK_MONOTONIC, HRTIMER_MODE_ABS);
+	dl_se->dl_timer.function = dl_task_timer;
+}
+
+#ifdef CONFIG_SCHED_HRTICK
+/*
+ * Budgets are typically a few milliseconds, well below the tick period,
+ * so budget enforcement uses the hrtick whenever high resolution timers
+ * are available, regardless of the HRTICK feature.
+ */
+static inline int dl_hrtick_enabled(struct rq *rq)
+{
+	if (!cpu_active(cpu_of(rq)))
+		return 0;
+	return hrtimer_is_hres_active(&rq->hrtick_timer);
+}
+
+static void start_hrtick_dl(struct rq *rq, struct task_struct *p)
+{
+	if (dl_hrtick_enabled(rq) && p->dl.runtime > 0)
+		hrtick_start(rq, p->dl.runtime);
+}
+#else
+static inline void start_hrtick_dl(struct rq *rq, struct task_struct *p)
+{
+}
+#endif
+
+/*
+ * Charge the current task for the time it ran, and throttle it if it
+ * went over budget.
+ */
+static void update_curr_dl(struct rq *rq)
+{
+	struct task_struct *curr = rq->curr;
+	struct sched_dl_entity *dl_se = &curr->dl;
+	u64 delta_exec;
+
+	if (!task_has_dl_policy(curr) || !on_dl_rq(dl_se))
+		return;
+
+	delta_exec = rq->clock - curr->se.exec_start;
+	if (unlikely((s64)delta_exec < 0))
+		delta_exec = 0;
+
+	schedstat_set(curr->se.statistics.exec_max,
+		      max(curr->se.statistics.exec_max, delta_exec));
+
+	curr->se.sum_exec_runtime += delta_exec;
+	account_group_exec_runtime(curr, delta_exec);
+
+	curr->se.exec_start = rq->clock;
+	cpuacct_charge(curr, delta_exec);
+
+	sched_rt_avg_update(rq, delta_exec);
+	sched_rt_charge_dl(rq, delta_exec);
+
+	dl_se->runtime -= delta_exec;
+	if (dl_se->runtime > 0)
+		return;
+
+	if (dl_se->dl_yielded) {
+		/* instance completed early: no overrun, full budget next time */
+		dl_se->dl_yielded = 0;
+		dl_se->runtime = 0;
+	} else {
+		dl_se->nr_overruns++;
+		if (dl_se->flags & SCHED_FLAG_DL_OVERRUN)
+			dl_se->dl_overrun = 1;
+	}
+
+	__dequeue_dl_entity(&rq->dl, dl_se);
+	if (likely(start_dl_timer(rq, dl_se)))
+		dl_se->dl_throttled = 1;
+	else
+		enqueue_task_dl(rq, curr, ENQUEUE_REPLENISH);
+
+	if (!is_leftmost(curr, &rq->dl))
+		resched_task(curr);
+}
+
+static void enqueue_task_dl(struct rq *rq, struct task_struct *p, int flags)
+{
+	struct sched_dl_entity *dl_se = &p->dl;
+
+	/*
+	 * A throttled task stays off the dl_rq until dl_task_timer()
+	 * replenishes it.
+	 */
+	if (dl_se->dl_throttled)
+		return;
+
+	if (flags & ENQUEUE_REPLENISH)
+		replenish_dl_entity(dl_se, rq->clock);
+	else if (dl_se->dl_new || (flags & ENQUEUE_WAKEUP))
+		update_dl_entity(dl_se, rq->clock);
+
+	__enqueue_dl_entity(&rq->dl, dl_se);
+}
+
+static void dequeue_task_dl(struct rq *rq, struct task_struct *p, int flags)
+{
+	update_curr_dl(rq);
+	__dequeue_dl_entity(&rq->dl, &p->dl);
+}
+
+/*
+ * sched_yield() from a deadline task means its current instance is
+ * done: give up the remaining budget and sleep until the next period.
+ */
+static void yield_task_dl(struct rq *rq)
+{
+	struct task_struct *p = rq->curr;
+
+	if (p->dl.runtime > 0) {
+		p->dl.dl_yielded = 1;
+		p->dl.runtime = 0;
+	}
+	update_rq_clock(rq);
+	update_curr_dl(rq);
+}
+
+static void check_preempt_curr_dl(struct rq *rq, struct task_struct *p,
+				  int flags)
+{
+	struct task_struct *curr = rq->curr;
+
+	if (p == curr)
+		return;
+
+	if (!task_has_dl_policy(curr) ||
+	    dl_time_before(p->dl.deadline, curr->dl.deadline))
+		resched_task(curr);
+}
+
+static struct task_struct *pick_next_task_dl(struct rq *rq)
+{
+	struct dl_rq *dl_rq = &rq->dl;
+	struct sched_dl_entity *dl_se;
+	struct task_struct *p;
+
+	if (!dl_rq->rb_leftmost)
+		return NULL;
+
+	dl_se = rb_entry(dl_rq->rb_leftmost, struct sched_dl_entity, rb_node);
+	p = dl_task_of(dl_se);
+	p->se.exec_start = rq->clock;
+
+	start_hrtick_dl(rq, p);
+
+	return p;
+}
+
+static void put_prev_task_dl(struct rq *rq, struct task_struct *p)
+{
+	update_curr_dl(rq);
+	p->se.exec_start = 0;
+}
+
+static void task_tick_dl(struct rq *rq, struct task_struct *p, int queued)
+{
+	update_curr_dl(rq);
+
+	if (on_dl_rq(&p->dl) && is_leftmost(p, &rq->dl))
+		start_hrtick_dl(rq, p);
+}
+
+static void set_curr_task_dl(struct rq *rq)
+{
+	struct task_struct *p = rq->curr;
+
+	p->se.exec_start = rq->clock;
+}
+
+#ifdef CONFIG_SMP
+static int
+select_task_rq_dl(struct rq *rq, struct task_struct *p, int sd_flag, int flags)
+{
+	return task_cpu(p);
+}
+#endif
+
+/*
+ * Release the bandwidth held by @p. Called with dl_bw_lock held.
+ */
+static void __dl_release_bw(struct task_struct *p)
+{
+	dl_total_bw -= p->dl.dl_bw;
+	p->dl.dl_bw = 0;
+}
+
+static void task_dead_dl(struct task_struct *p)
+{
+	unsigned long flags;
+
+	hrtimer_cancel(&p->dl.dl_timer);
+
+	raw_spin_lock_irqsave(&dl_bw_lock, flags);
+	__dl_release_bw(p);
+	raw_spin_unlock_irqrestore(&dl_bw_lock, flags);
+}
+
+static void switched_from_dl(struct rq *rq, struct task_struct *p,
+			     int running)
+{
+	/* dl_task_timer() checks the policy if it is already running */
+	hrtimer_try_to_cancel(&p->dl.dl_timer);
+	p->dl.dl_throttled = 0;
+	p->dl.dl_overrun = 0;
+}
+
+static void switched_to_dl(struct rq *rq, struct task_struct *p,
+			   int running)
+{
+	if (!running && p->se.on_rq)
+		check_preempt_curr_dl(rq, p, 0);
+}
+
+static void prio_changed_dl(struct rq *rq, struct task_struct *p,
+			    int oldprio, int running)
+{
+	/* new parameters: the deadline may have moved either way */
+	if (running) {
+		if (!is_leftmost(p, &rq->dl))
+			resched_task(p);
+	} else if (p->se.on_rq) {
+		check_preempt_curr_dl(rq, p, 0);
+	}
+}
+
+static unsigned int get_rr_interval_dl(struct rq *rq, struct task_struct *task)
+{
+	return 0;
+}
+
+static const struct sched_class dl_sched_class = {
+	.next			= &rt_sched_class,
+	.enqueue_task		= enqueue_task_dl,
+	.dequeue_task		= dequeue_task_dl,
+	.yield_task		= yield_task_dl,
+
+	.check_preempt_curr	= check_preempt_curr_dl,
+
+	.pick_next_task		= pick_next_task_dl,
+	.put_prev_task		= put_prev_task_dl,
+
+#ifdef CONFIG_SMP
+	.select_task_rq		= select_task_rq_dl,
+#endif
+
+	.set_curr_task		= set_curr_task_dl,
+	.task_tick		= task_tick_dl,
+
+	.get_rr_interval	= get_rr_interval_dl,
+
+	.switched_from		= switched_from_dl,
+	.switched_to		= switched_to_dl,
+	.prio_changed		= prio_changed_dl,
+
+	.task_dead		= task_dead_dl,
+};
+
+/*
+ * Parameters handling, used by __sched_setscheduler().
+ */
+
+static void __sched_fork_dl(struct task_struct *p)
+{
+	struct sched_dl_entity *dl_se = &p->dl;
+
+	RB_CLEAR_NODE(&dl_se->rb_node);
+	dl_se->dl_runtime = 0;
+	dl_se->dl_deadline = 0;
+	dl_se->dl_period = 0;
+	dl_se->dl_bw = 0;
+	dl_se->flags = 0;
+	dl_se->runtime = 0;
+	dl_se->deadline = 0;
+	dl_se->dl_new = 1;
+	dl_se->dl_throttled = 0;
+	dl_se->dl_yielded = 0;
+	dl_se->dl_overrun = 0;
+	dl_se->nr_overruns = 0;
+	init_dl_task_timer(dl_se);
+}
+
+/*
+ * Sanity check the reservation: it must be at least 2^DL_SCALE ns, and
+ * runtime <= deadline <= period. A zero period means period == deadline.
+ */
+static bool __checkparam_dl(const struct sched_attr *attr)
+{
+	u64 period = attr->sched_period ?: attr->sched_deadline;
+
+	if (attr->sched_flags & ~(SCHED_FLAG_RESET_ON_FORK |
+				  SCHED_FLAG_DL_OVERRUN))
+		return false;
+
+	if (attr->sched_deadline == 0 ||
+	    attr->sched_runtime < (1ULL << DL_SCALE))
+		return false;
+
+	/* keep the periods within what the s64 arithmetic can handle */
+	if (period & (1ULL << 63))
+		return false;
+
+	return attr->sched_runtime <= attr->sched_deadline &&
+	       attr->sched_deadline <= period;
+}
+
+static void __setparam_dl(struct task_struct *p, const struct sched_attr *attr)
+{
+	struct sched_dl_entity *dl_se = &p->dl;
+
+	hrtimer_try_to_cancel(&dl_se->dl_timer);
+
+	dl_se->dl_runtime = attr->sched_runtime;
+	dl_se->dl_deadline = attr->sched_deadline;
+	dl_se->dl_period = attr->sched_period ?: dl_se->dl_deadline;
+	dl_se->flags = attr->sched_flags;
+	dl_se->dl_new = 1;
+	dl_se->dl_throttled = 0;
+	dl_se->dl_yielded = 0;
+	dl_se->dl_overrun = 0;
+}
+
+static void __getparam_dl(struct task_struct *p, struct sched_attr *attr)
+{
+	struct sched_dl_entity *dl_se = &p->dl;
+
+	attr->sched_runtime = dl_se->dl_runtime;
+	attr->sched_deadline = dl_se->dl_deadline;
+	attr->sched_period = dl_se->dl_period;
+	attr->sched_flags |= dl_se->flags & SCHED_FLAG_DL_OVERRUN;
+}
+
+/*
+ * Admission control: account for the bandwidth @p will hold once it has
+ * switched to @policy with parameters @attr, failing if that would go
+ * over the limit. Called with p->pi_lock and the rq lock held.
+ */
+static int dl_overflow(struct task_struct *p, int policy,
+		       const struct sched_attr *attr)
+{
+	u64 period = attr ? (attr->sched_period ?: attr->sched_deadline) : 0;
+	u64 new_bw = dl_policy(policy) ? dl_bw_of(period, attr->sched_runtime)
+				       : 0;
+	int err = 0;
+
+	if (!dl_policy(policy) && !task_has_dl_policy(p))
+		return 0;
+	if (task_has_dl_policy(p) && new_bw == p->dl.dl_bw)
+		return 0;
+
+	raw_spin_lock(&dl_bw_lock);
+	if (dl_policy(policy)) {
+		if (dl_total_bw - p->dl.dl_bw + new_bw <= dl_bw_limit()) {
+			dl_total_bw += new_bw - p->dl.dl_bw;
+			p->dl.dl_bw = new_bw;
+		} else {
+			err = -EBUSY;
+		}
+	} else {
+		__dl_release_bw(p);
+	}
+	raw_spin_unlock(&dl_bw_lock);
+
+	return err;
+}
+
+/*
+ * Drop the reservation of @p without going through admission control,
+ * for tasks forced back to SCHED_NORMAL.
+ */
+static void dl_release_bw(struct task_struct *p)
+{
+	raw_spin_lock(&dl_bw_lock);
+	__dl_release_bw(p);
+	raw_spin_unlock(&dl_bw_lock);
+}
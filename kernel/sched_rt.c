@@ -639,6 +639,30 @@ static void update_curr_rt(struct rq *rq)
 	}
 }
 
+/*
+ * SCHED_DEADLINE tasks use the RT bandwidth too: their runtime is charged
+ * to the root rt_rq, so that RT and deadline tasks together stay within
+ * sched_rt_runtime_us. The period timer only runs while RT tasks are
+ * queued; without it nothing replenishes rt_time, so stop charging once
+ * a full budget is accounted.
+ */
+static void sched_rt_charge_dl(struct rq *rq, u64 delta_exec)
+{
+	struct rt_rq *rt_rq = &rq->rt;
+	struct rt_bandwidth *rt_b = sched_rt_bandwidth(rt_rq);
+
+	if (!rt_bandwidth_enabled() || sched_rt_runtime(rt_rq) == RUNTIME_INF)
+		return;
+
+	raw_spin_lock(&rt_rq->rt_runtime_lock);
+	if (hrtimer_active(&rt_b->rt_period_timer) ||
+	    rt_rq->rt_time < sched_rt_runtime(rt_rq)) {
+		rt_rq->rt_time += delta_exec;
+		sched_rt_runtime_exceeded(rt_rq);
+	}
+	raw_spin_unlock(&rt_rq->rt_runtime_lock);
+}
+
 #if defined CONFIG_SMP
 
 static struct task_struct *pick_next_highest_task_rt(struct rq *rq, int cpu);
@@ -50,6 +50,8 @@
 #include <linux/kmemleak.h>
 #include <linux/memory.h>
 #include <linux/compaction.h>
+#include <linux/migrate.h>
+#include <linux/mm_inline.h>
 #include <trace/events/kmem.h>
 #include <linux/ftrace_event.h>
 
@@ -818,11 +820,17 @@ struct page *__rmqueue_smallest(struct zone *zone, unsigned int order,
  * This array describes the order lists are fallen back to when
  * the free lists for the desirable migrate type are depleted
  */
-static int fallbacks[MIGRATE_TYPES][MIGRATE_TYPES-1] = {
-	[MIGRATE_UNMOVABLE]   = { MIGRATE_RECLAIMABLE, MIGRATE_MOVABLE,   MIGRATE_RESERVE },
-	[MIGRATE_RECLAIMABLE] = { MIGRATE_UNMOVABLE,   MIGRATE_MOVABLE,   MIGRATE_RESERVE },
-	[MIGRATE_MOVABLE]     = { MIGRATE_RECLAIMABLE, MIGRATE_UNMOVABLE, MIGRATE_RESERVE },
-	[MIGRATE_RESERVE]     = { MIGRATE_RESERVE,     MIGRATE_RESERVE,   MIGRATE_RESERVE }, /* Never used */
+static int fallbacks[MIGRATE_TYPES][4] = {
+	[MIGRATE_UNMOVABLE]   = { MIGRATE_RECLAIMABLE, MIGRATE_MOVABLE,     MIGRATE_RESERVE },
+	[MIGRATE_RECLAIMABLE] = { MIGRATE_UNMOVABLE,   MIGRATE_MOVABLE,     MIGRATE_RESERVE },
+#ifdef CONFIG_CMA
+	[MIGRATE_MOVABLE]     = { MIGRATE_CMA,         MIGRATE_RECLAIMABLE, MIGRATE_UNMOVABLE, MIGRATE_RESERVE },
+	[MIGRATE_CMA]         = { MIGRATE_RESERVE }, /* Never used */
+#else
+	[MIGRATE_MOVABLE]     = { MIGRATE_RECLAIMABLE, MIGRATE_UNMOVABLE,   MIGRATE_RESERVE },
+#endif
+	[MIGRATE_RESERVE]     = { MIGRATE_RESERVE }, /* Never used */
+	[MIGRATE_ISOLATE]     = { MIGRATE_RESERVE }, /* Never used */
 };
 
 /*
@@ -918,12 +926,12 @@ __rmqueue_fallback(struct zone *zone, int order, int start_migratetype)
 	/* Find the largest possible block of pages in the other list */
 	for (current_order = MAX_ORDER-1; current_order >= order;
 						--current_order) {
-		for (i = 0; i < MIGRATE_TYPES - 1; i++) {
+		for (i = 0;; i++) {
 			migratetype = fallbacks[start_migratetype][i];
 
 			/* MIGRATE_RESERVE handled later if necessary */
 			if (migratetype == MIGRATE_RESERVE)
-				continue;
+				break;
 
 			area = &(zone->free_area[current_order]);
 			if (list_empty(&area->free_list[migratetype]))
@@ -937,11 +945,16 @@ __rmqueue_fallback(struct zone *zone, int order, int start_migratetype)
 			 * If breaking a large block of pages, move all free
 			 * pages to the preferred allocation list. If falling
 			 * back for a reclaimable kernel allocation, be more
-			 * agressive about taking ownership of free pages
+			 * agressive about taking ownership of free pages.
+			 *
+			 * MIGRATE_CMA pageblocks are only lent to movable
+			 * allocations: never move their free pages to another
+			 * list nor change their type.
 			 */
-			if (unlikely(current_order >= (pageblock_order >> 1)) ||
+			if (!is_migrate_cma(migratetype) &&
+			    (unlikely(current_order >= (pageblock_order >> 1)) ||
 					start_migratetype == MIGRATE_RECLAIMABLE ||
-					page_group_by_mobility_disabled) {
+					page_group_by_mobility_disabled)) {
 				unsigned long pages;
 				pages = move_freepages_block(zone, page,
 								start_migratetype);
@@ -960,7 +973,8 @@ __rmqueue_fallback(struct zone *zone, int order, int start_migratetype)
 			rmv_page_order(page);
 
 			/* Take ownership for orders >= pageblock_order */
-			if (current_order >= pageblock_order)
+			if (current_order >= pageblock_order &&
+			    !is_migrate_cma(migratetype))
 				change_pageblock_range(page, current_order,
 							start_migratetype);
 
@@ -1036,7 +1050,16 @@ static int rmqueue_bulk(struct zone *zone, unsigned int order,
 			list_add(&page->lru, list);
 		else
 			list_add_tail(&page->lru, list);
-		set_page_private(page, migratetype);
+#ifdef CONFIG_CMA
+		/*
+		 * Remember where CMA pages come from, so that draining the
+		 * pcp list gives them back to the MIGRATE_CMA free list.
+		 */
+		if (is_migrate_cma(get_pageblock_migratetype(page)))
+			set_page_private(page, MIGRATE_CMA);
+		else
+#endif
+			set_page_private(page, migratetype);
 		list = &page->lru;
 	}
 	__mod_zone_page_state(zone, NR_FREE_PAGES, -(i << order));
@@ -5297,6 +5320,7 @@ int set_migratetype_isolate(struct page *page)
 
 	spin_lock_irqsave(&zone->lock, flags);
 	if (get_pageblock_migratetype(page) == MIGRATE_MOVABLE ||
+	    is_migrate_cma(get_pageblock_migratetype(page)) ||
 	    zone_idx == ZONE_MOVABLE) {
 		ret = 0;
 		goto out;
@@ -5349,7 +5373,7 @@ out:
 	return ret;
 }
 
-void unset_migratetype_isolate(struct page *page)
+void unset_migratetype_isolate(struct page *page, unsigned migratetype)
 {
 	struct zone *zone;
 	unsigned long flags;
@@ -5357,12 +5381,230 @@ void unset_migratetype_isolate(struct page *page)
 	spin_lock_irqsave(&zone->lock, flags);
 	if (get_pageblock_migratetype(page) != MIGRATE_ISOLATE)
 		goto out;
-	set_pageblock_migratetype(page, MIGRATE_MOVABLE);
-	move_freepages_block(zone, page, MIGRATE_MOVABLE);
+	set_pageblock_migratetype(page, migratetype);
+	move_freepages_block(zone, page, migratetype);
 out:
 	spin_unlock_irqrestore(&zone->lock, flags);
 }
 
+#ifdef CONFIG_CMA
+/*
+ * Hand a pageblock reserved at boot by the contiguous memory allocator
+ * over to the buddy allocator. It is tagged MIGRATE_CMA so that only
+ * movable allocations may borrow it.
+ */
+void __init init_cma_reserved_pageblock(struct page *page)
+{
+	unsigned i = pageblock_nr_pages;
+	struct page *p = page;
+
+	do {
+		__ClearPageReserved(p);
+		set_page_count(p, 0);
+	} while (++p, --i);
+
+	set_page_refcounted(page);
+	set_pageblock_migratetype(page, MIGRATE_CMA);
+	__free_pages(page, pageblock_order);
+	totalram_pages += pageblock_nr_pages;
+}
+
+static struct page *
+__alloc_contig_migrate_alloc(struct page *page, unsigned long private,
+			     int **resultp)
+{
+	return alloc_page(GFP_HIGHUSER_MOVABLE);
+}
+
+#define NR_CONTIG_MIGRATE_AT_ONCE	(256)
+#define NR_CONTIG_MIGRATE_RETRIES	(5)
+
+/*
+ * Move every in-use page of [start, end) elsewhere. The range must be
+ * isolated, so that the new pages cannot be allocated from it.
+ */
+static int __alloc_contig_migrate_range(unsigned long start, unsigned long end)
+{
+	unsigned long pfn = start;
+	unsigned long batch;
+	int tries = 0;
+	int ret = 0;
+	LIST_HEAD(source);
+
+	migrate_prep();
+
+	while (pfn < end) {
+		int nr = 0;
+
+		if (fatal_signal_pending(current))
+			return -EINTR;
+
+		for (batch = pfn; pfn < end && nr < NR_CONTIG_MIGRATE_AT_ONCE;
+		     pfn++) {
+			struct page *page = pfn_to_page(pfn);
+
+			if (!page_count(page) || PageBuddy(page))
+				continue;
+			if (isolate_lru_page(page))
+				continue;
+			list_add_tail(&page->lru, &source);
+			inc_zone_page_state(page, NR_ISOLATED_ANON +
+					    page_is_file_cache(page));
+			nr++;
+		}
+
+		if (list_empty(&source))
+			continue;
+
+		/*
+		 * this function returns # of failed pages, which are put
+		 * back on the LRU: scan the same batch again in that case.
+		 */
+		ret = migrate_pages(&source, __alloc_contig_migrate_alloc,
+				    0, 1);
+		if (ret == 0) {
+			tries = 0;
+			continue;
+		}
+		if (++tries == NR_CONTIG_MIGRATE_RETRIES)
+			break;
+		pfn = batch;
+	}
+
+	return ret > 0 ? -EBUSY : ret;
+}
+
+/*
+ * Take the free pages of [start, end) off the buddy lists. The range must
+ * be isolated and free. Every page is returned with a refcount of one.
+ */
+static unsigned long __grab_isolated_range(unsigned long start,
+					   unsigned long end)
+{
+	struct zone *zone = page_zone(pfn_to_page(start));
+	unsigned long pfn = start;
+	unsigned long flags;
+
+	spin_lock_irqsave(&zone->lock, flags);
+	while (pfn < end) {
+		struct page *page = pfn_to_page(pfn);
+		int order;
+
+		if (!PageBuddy(page))
+			break;
+
+		order = page_order(page);
+		list_del(&page->lru);
+		rmv_page_order(page);
+		zone->free_area[order].nr_free--;
+		__mod_zone_page_state(zone, NR_FREE_PAGES, -(1UL << order));
+
+		set_page_refcounted(page);
+		split_page(page, order);
+		pfn += 1UL << order;
+	}
+	spin_unlock_irqrestore(&zone->lock, flags);
+
+	return pfn;
+}
+
+/**
+ * alloc_contig_range() -- tries to allocate given range of pages
+ * @start:	start PFN to allocate
+ * @end:	one-past-the-last PFN to allocate
+ * @migratetype:	migratetype of the underlying pageblocks, either
+ *			MIGRATE_MOVABLE or MIGRATE_CMA
+ *
+ * The PFN range does not have to be pageblock or MAX_ORDER_NR_PAGES
+ * aligned, but all of it must belong to a single zone. Pages in use in the
+ * range are migrated away first.
+ *
+ * Returns zero on success or a negative error code. On success all pages
+ * in the range are allocated and must be released with free_contig_range().
+ */
+int alloc_contig_range(unsigned long start, unsigned long end,
+		       unsigned migratetype)
+{
+	unsigned long align = max_t(unsigned long, MAX_ORDER_NR_PAGES,
+				    pageblock_nr_pages);
+	unsigned long iso_start = start & ~(align - 1);
+	unsigned long iso_end = ALIGN(end, align);
+	unsigned long outer_start, outer_end;
+	unsigned int order;
+	int ret;
+
+	/*
+	 * Isolate whole MAX_ORDER blocks, so that the free pages around
+	 * [start, end) cannot be merged with the ones inside and handed out
+	 * meanwhile. Only [start, end) has to be free though: the rest of the
+	 * blocks may be in use, e.g. by earlier allocations.
+	 */
+	ret = start_isolate_page_range(iso_start, iso_end, migratetype);
+	if (ret)
+		return ret;
+
+	ret = __alloc_contig_migrate_range(start, end);
+	if (ret)
+		goto done;
+
+	/*
+	 * Migrated pages may still sit on per-cpu lists: bring everything
+	 * back to the buddy lists.
+	 */
+	lru_add_drain_all();
+	drain_all_pages();
+
+	/*
+	 * The free page holding start may begin before it: find its head.
+	 * A smaller free page below start that does not reach it means start
+	 * itself is the head (or busy, which test_pages_isolated() reports).
+	 */
+	order = 0;
+	outer_start = start;
+	while (!PageBuddy(pfn_to_page(outer_start))) {
+		if (++order >= MAX_ORDER) {
+			outer_start = start;
+			break;
+		}
+		outer_start &= ~0UL << order;
+	}
+	if (outer_start != start &&
+	    outer_start + (1UL << page_order(pfn_to_page(outer_start))) <= start)
+		outer_start = start;
+
+	if (test_pages_isolated(outer_start, end)) {
+		ret = -EBUSY;
+		goto done;
+	}
+
+	/* The last free page taken may extend beyond end */
+	outer_end = __grab_isolated_range(outer_start, end);
+	if (outer_end < end) {
+		pr_warning("alloc_contig_range: page %lx is not free\n",
+			   outer_end);
+		free_contig_range(outer_start, outer_end - outer_start);
+		ret = -EBUSY;
+		goto done;
+	}
+
+	/* Give back the pages we have grabbed beyond the requested range */
+	if (start != outer_start)
+		free_contig_range(outer_start, start - outer_start);
+	if (end != outer_end)
+		free_contig_range(end, outer_end - end);
+
+done:
+	undo_isolate_page_range(iso_start, iso_end, migratetype);
+	return ret;
+}
+
+void free_contig_range(unsigned long pfn, unsigned nr_pages)
+{
+	for (; nr_pages--; ++pfn)
+		__free_page(pfn_to_page(pfn));
+}
+#endif
+
 #ifdef CONFIG_MEMORY_HOTREMOVE
 /*
  * All pages in the range must be isolated before calling this.
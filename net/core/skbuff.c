@@ -329,6 +329,16 @@ static void skb_clone_fraglist(struct sk_buff *skb)
 		skb_get(list);
 }
 
+/* The data area @to now also refers to the zero copy frags of @from */
+static void skb_zerocopy_get(struct sk_buff *to, struct sk_buff *from)
+{
+	struct ubuf_info *uarg = skb_shinfo(from)->destructor_arg;
+
+	skb_tx(to)->dev_zerocopy = 1;
+	skb_shinfo(to)->destructor_arg = uarg;
+	atomic_inc(&uarg->refcnt);
+}
+
 static void skb_release_data(struct sk_buff *skb)
 {
 	if (!skb->cloned ||
@@ -340,6 +350,14 @@ static void skb_release_data(struct sk_buff *skb)
 				put_page(skb_shinfo(skb)->frags[i].page);
 		}
 
+		/* the frags are released, hand them back to the sender */
+		if (skb_tx(skb)->dev_zerocopy) {
+			struct ubuf_info *uarg = skb_shinfo(skb)->destructor_arg;
+
+			if (atomic_dec_and_test(&uarg->refcnt))
+				uarg->callback(uarg);
+		}
+
 		if (skb_has_frags(skb))
 			skb_drop_fraglist(skb);
 
@@ -499,6 +517,10 @@ bool skb_recycle_check(struct sk_buff *skb, int skb_size)
 	if (skb_shared(skb) || skb_cloned(skb))
 		return false;
 
+	/* the sender is waiting for skb_release_data() */
+	if (skb_tx(skb)->dev_zerocopy)
+		return false;
+
 	skb_release_head_state(skb);
 
 	shinfo = skb_shinfo(skb);
@@ -757,6 +779,8 @@ struct sk_buff *pskb_copy(struct sk_buff *skb, gfp_t gfp_mask)
 			get_page(skb_shinfo(n)->frags[i].page);
 		}
 		skb_shinfo(n)->nr_frags = i;
+		if (skb_tx(skb)->dev_zerocopy)
+			skb_zerocopy_get(n, skb);
 	}
 
 	if (skb_has_frags(skb)) {
@@ -822,6 +846,13 @@ int pskb_expand_head(struct sk_buff *skb, int nhead, int ntail,
 	for (i = 0; i < skb_shinfo(skb)->nr_frags; i++)
 		get_page(skb_shinfo(skb)->frags[i].page);
 
+	/* the new data area got the zero copy state with the frags */
+	if (skb_tx(skb)->dev_zerocopy) {
+		struct ubuf_info *uarg = skb_shinfo(skb)->destructor_arg;
+
+		atomic_inc(&uarg->refcnt);
+	}
+
 	if (skb_has_frags(skb))
 		skb_clone_fraglist(skb);
 
@@ -2084,6 +2115,9 @@ void skb_split(struct sk_buff *skb, struct sk_buff *skb1, const u32 len)
 		skb_split_inside_header(skb, skb1, len, pos);
 	else		/* Second chunk has no header, nothing to copy. */
 		skb_split_no_header(skb, skb1, len, pos);
+
+	if (skb_shinfo(skb1)->nr_frags && skb_tx(skb)->dev_zerocopy)
+		skb_zerocopy_get(skb1, skb);
 }
 EXPORT_SYMBOL(skb_split);
 